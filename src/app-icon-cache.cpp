@@ -0,0 +1,78 @@
+#include "app-icon-cache.hpp"
+
+#include <obs-module.h>
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QPixmap>
+
+
+constexpr qint64 ICON_CACHE_MAX_BYTES = 4 * 1024 * 1024;
+
+
+AppIconCache::AppIconCache(QObject *parent)
+    : QObject(parent), cache(ICON_CACHE_MAX_BYTES) {
+}
+
+QString AppIconCache::cacheKey(const QString &executablePath, int pixelSize) {
+    // Icons are rasterized per DPI, so a monitor change gets its own entry rather than a blurry rescale
+    return executablePath + QLatin1Char('@') + QString::number(pixelSize);
+}
+
+QImage AppIconCache::extractIcon(const QString &executablePath, int pixelSize) {
+    HICON hicon = nullptr;
+    HRESULT result = SHDefExtractIconW((LPCWSTR)executablePath.utf16(), 0, 0, &hicon, nullptr, MAKELONG(pixelSize, 0));
+    if (result != S_OK || !hicon) {
+        return QImage();
+    }
+
+    QImage image = QImage::fromHICON(hicon);
+    DestroyIcon(hicon);
+
+    return image;
+}
+
+QIcon AppIconCache::icon(const QString &executablePath, int pixelSize) {
+    if (executablePath.isEmpty()) {
+        return QIcon();
+    }
+
+    QString key = cacheKey(executablePath, pixelSize);
+    if (QIcon *cached = cache.object(key)) {
+        return *cached;
+    }
+
+    if (pending.contains(key)) {
+        return QIcon();
+    }
+    pending.insert(key);
+
+    // Extract off the UI thread; QImage is safe to build there, the QIcon is made once back on the UI thread
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key, executablePath]() {
+        QImage image = watcher->result();
+        watcher->deleteLater();
+        pending.remove(key);
+
+        // Failed extractions are cached as empty icons as well, so they are not retried on every enumeration
+        qint64 cost = qMax<qint64>(image.sizeInBytes(), 1);
+        cache.insert(key, new QIcon(image.isNull() ? QIcon() : QIcon(QPixmap::fromImage(image))), cost);
+
+        // blog(LOG_INFO, "Icon cache: %d icons, %lld bytes", count(), memoryUsage());
+
+        if (!image.isNull()) {
+            emit iconReady(executablePath);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&AppIconCache::extractIcon, executablePath, pixelSize));
+
+    return QIcon();
+}
+
+qint64 AppIconCache::memoryUsage() const {
+    return cache.totalCost();
+}
+
+int AppIconCache::count() const {
+    return (int)cache.count();
+}
\ No newline at end of file
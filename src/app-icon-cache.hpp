@@ -0,0 +1,38 @@
+#pragma once
+
+#include <windows.h>
+#include <shlobj.h>
+
+#include <QObject>
+#include <QCache>
+#include <QIcon>
+#include <QImage>
+#include <QSet>
+#include <QString>
+
+#pragma comment(lib, "Shell32.lib")
+
+
+// Application icons for the window picker, keyed by executable path. Icons are extracted once on a
+// worker thread at the requested pixel size and kept in an LRU cache bounded by their raster size.
+class AppIconCache : public QObject {
+    Q_OBJECT
+
+public:
+    explicit AppIconCache(QObject *parent = nullptr);
+
+    QIcon icon(const QString &executablePath, int pixelSize);
+
+    qint64 memoryUsage() const;
+    int count() const;
+
+signals:
+    void iconReady(const QString &executablePath);
+
+private:
+    static QString cacheKey(const QString &executablePath, int pixelSize);
+    static QImage extractIcon(const QString &executablePath, int pixelSize);
+
+    QCache<QString, QIcon> cache;
+    QSet<QString> pending;
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "dock-config.hpp"
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*------------------------------------SERIALIZATION------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+template <typename Value>
+struct DockConfigField {
+    QLatin1String key;
+    Value DockConfig::*member;
+    bool optional; // Left out of the file while empty
+};
+
+constexpr DockConfigField<QString> STRING_FIELDS[] = {
+    {DockConfigKeys::DockId, &DockConfig::dockId, false},
+    {DockConfigKeys::DockName, &DockConfig::dockName, false},
+    {DockConfigKeys::DesktopWindow, &DockConfig::desktopWindow, false},
+    {DockConfigKeys::DesktopWindowWithProgramName, &DockConfig::desktopWindowWithProgramName, false},
+    {DockConfigKeys::Layout, &DockConfig::layout, true},
+};
+
+constexpr DockConfigField<QJsonArray> ARRAY_FIELDS[] = {
+    {DockConfigKeys::Tiles, &DockConfig::tiles, true},
+};
+
+constexpr DockConfigField<QJsonObject> OBJECT_FIELDS[] = {
+    {DockConfigKeys::Fingerprint, &DockConfig::fingerprint, true},
+};
+
+static void readValue(const QJsonValue &value, QString &target) {
+    target = value.toString();
+}
+
+static void readValue(const QJsonValue &value, QJsonArray &target) {
+    target = value.toArray();
+}
+
+static void readValue(const QJsonValue &value, QJsonObject &target) {
+    target = value.toObject();
+}
+
+template <typename Value, size_t Count>
+static void writeFields(const DockConfig &config, const DockConfigField<Value> (&fields)[Count], QJsonObject &dockObject) {
+    for (const DockConfigField<Value> &field : fields) {
+        const Value &value = config.*field.member;
+        if (!field.optional || !value.isEmpty()) {
+            dockObject.insert(field.key, value);
+        }
+    }
+}
+
+template <typename Value, size_t Count>
+static void readFields(const QJsonObject &dockObject, const DockConfigField<Value> (&fields)[Count], DockConfig &config) {
+    for (const DockConfigField<Value> &field : fields) {
+        readValue(dockObject.value(field.key), config.*field.member);
+    }
+}
+
+QJsonObject DockConfig::toJson() const {
+    QJsonObject dockObject;
+    writeFields(*this, STRING_FIELDS, dockObject);
+    writeFields(*this, ARRAY_FIELDS, dockObject);
+    writeFields(*this, OBJECT_FIELDS, dockObject);
+    return dockObject;
+}
+
+DockConfig DockConfig::fromJson(const QJsonObject &dockObject) {
+    DockConfig config;
+    readFields(dockObject, STRING_FIELDS, config);
+    readFields(dockObject, ARRAY_FIELDS, config);
+    readFields(dockObject, OBJECT_FIELDS, config);
+    return config;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLatin1String>
+#include <QSet>
+#include <QString>
+
+#include <cstdint>
+
+
+// Keys of a dock object in config.json. They are static Latin-1 data, looking one up builds no string.
+namespace DockConfigKeys {
+    constexpr QLatin1String DockId("dockId");
+    constexpr QLatin1String DockName("dockName");
+    constexpr QLatin1String DesktopWindow("desktopWindow");
+    constexpr QLatin1String DesktopWindowWithProgramName("desktopWindowWithProgramName");
+    constexpr QLatin1String Tiles("tiles");
+    constexpr QLatin1String Layout("layout");
+    constexpr QLatin1String Fingerprint("fingerprint");
+}
+
+
+// One dock as stored in config.json. The fields and their keys are listed once in a table in
+// dock-config.cpp, which both toJson() and fromJson() walk.
+struct DockConfig {
+    QString dockId;
+    QString dockName;
+    QString desktopWindow;
+    QString desktopWindowWithProgramName;
+    QJsonArray tiles;
+    QString layout;
+    QJsonObject fingerprint;
+
+    bool isEmpty() const {
+        return dockId.isEmpty();
+    }
+
+    bool isTiled() const {
+        return !tiles.isEmpty();
+    }
+
+    QJsonObject toJson() const;
+    static DockConfig fromJson(const QJsonObject &dockObject);
+};
+
+
+// A row of the dock dialog: the dock as it was loaded and as it has been edited since. Both start out
+// sharing the same string data, and the setters keep a dirty mask up to date so the Apply planning
+// never has to compare strings.
+struct DockEntry {
+    enum DirtyField : uint8_t {
+        DirtyDockId = 1 << 0,
+        DirtyDockName = 1 << 1,
+        DirtyDesktopWindow = 1 << 2,
+        DirtyLabel = 1 << 3,
+        DirtyTiles = 1 << 4
+    };
+
+    DockConfig original;
+    DockConfig current;
+
+    DockEntry() = default;
+
+    explicit DockEntry(const DockConfig &config) : original(config), current(config) {}
+
+    void setDockId(const QString &dockId) {
+        current.dockId = dockId;
+        markDirty(DirtyDockId, dockId != original.dockId);
+    }
+
+    void setDockName(const QString &dockName) {
+        current.dockName = dockName;
+        markDirty(DirtyDockName, dockName != original.dockName);
+    }
+
+    void setTarget(const QString &desktopWindow, const QString &desktopWindowWithProgramName) {
+        current.desktopWindow = desktopWindow;
+        current.desktopWindowWithProgramName = desktopWindowWithProgramName;
+        markDirty(DirtyDesktopWindow, desktopWindow != original.desktopWindow);
+        markDirty(DirtyLabel, desktopWindowWithProgramName != original.desktopWindowWithProgramName);
+    }
+
+    void setTiles(const QJsonArray &tiles, const QString &layout) {
+        current.tiles = tiles;
+        current.layout = layout;
+        markDirty(DirtyTiles, tiles != original.tiles || layout != original.layout);
+    }
+
+    bool isNew() const {
+        return original.dockId.isEmpty();
+    }
+
+    bool isTiled() const {
+        return current.isTiled();
+    }
+
+    bool isRenamed() const {
+        return dirty & DirtyDockName;
+    }
+
+    bool isRetargeted() const {
+        return dirty & DirtyDesktopWindow;
+    }
+
+    // OBS knows a dock by its ID, and a tiled dock takes its windows when it is built
+    bool needsRecreate() const {
+        return dirty & (DirtyDockId | DirtyTiles);
+    }
+
+    bool isModified() const {
+        return dirty != 0;
+    }
+
+    bool isUnchanged() const {
+        return dirty == 0;
+    }
+
+private:
+    void markDirty(uint8_t field, bool changed) {
+        dirty = changed ? (dirty | field) : (dirty & ~field);
+    }
+
+    uint8_t dirty = 0;
+};
+
+
+// Every copy of a dock ID (dock maps, entries, fingerprints, hotkeys) shares the data of one interned
+// QString, so passing IDs around only touches a reference count. An ID is interned once a dock or a
+// dialog row takes it and released with them, so the pool never outgrows the configured docks.
+class DockIdPool {
+public:
+    QString intern(const QString &dockId) {
+        auto idIter = ids.constFind(dockId);
+        if (idIter != ids.constEnd()) {
+            return *idIter;
+        }
+        return *ids.insert(dockId);
+    }
+
+    // Copies still held elsewhere stay valid, they just no longer share data with later interns
+    void release(const QString &dockId) {
+        ids.remove(dockId);
+    }
+
+    qsizetype size() const {
+        return ids.size();
+    }
+
+private:
+    QSet<QString> ids;
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "dock-log.hpp"
+
+#include <util/platform.h>
+
+#include <cstdio>
+
+
+DockLog& DockLog::instance() {
+    static DockLog dockLog;
+    return dockLog;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*--------------------------------------RECORDING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void DockLog::write(DockLogSite &site, int level, const char *format, const int64_t (&args)[DOCK_LOG_MAX_ARGS]) {
+    uint64_t now = os_gettime_ns();
+
+    // Errors always get through, everything else is limited per call site
+    if (level > LOG_ERROR) {
+        uint64_t windowStartNs = site.windowStartNs.load(std::memory_order_relaxed);
+        if (now - windowStartNs >= DOCK_LOG_SITE_WINDOW_NS &&
+            site.windowStartNs.compare_exchange_strong(windowStartNs, now, std::memory_order_relaxed)) {
+            site.written.store(0, std::memory_order_relaxed);
+        }
+        if (site.written.fetch_add(1, std::memory_order_relaxed) >= DOCK_LOG_SITE_BURST) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Reserve a slot, fill it in, and only then publish it under its position
+    uint64_t position = head.fetch_add(1, std::memory_order_relaxed);
+    DockLogRecord &entry = ring[position & (DOCK_LOG_RING_SIZE - 1)];
+    entry.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.timestampNs = now;
+    entry.format = format;
+    for (int i = 0; i < DOCK_LOG_MAX_ARGS; ++i) {
+        entry.args[i] = args[i];
+    }
+    entry.level = level;
+    entry.suppressedBefore = site.suppressed.exchange(0, std::memory_order_relaxed);
+    entry.sequence.store(position + 1, std::memory_order_release);
+
+    if (level <= LOG_ERROR) {
+        flush("error");
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------FLUSHING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void DockLog::flush(const char *reason) {
+    std::lock_guard<std::mutex> lock(flushMutex);
+
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = flushedHead;
+    if (end - begin > DOCK_LOG_RING_SIZE) {
+        begin = end - DOCK_LOG_RING_SIZE;
+    }
+    if (begin == end) {
+        return;
+    }
+
+    blog(LOG_INFO, "Window dock log (%s): %d records, %d overwritten", reason, (int)(end - begin),
+         (int)(begin - flushedHead));
+
+    char message[512];
+    int skipped = 0;
+    for (uint64_t i = begin; i < end; ++i) {
+        const DockLogRecord &slot = ring[i & (DOCK_LOG_RING_SIZE - 1)];
+
+        // Copy the record out and check it was neither still being written nor overwritten meanwhile
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        DockLogRecord entry;
+        entry.timestampNs = slot.timestampNs;
+        entry.format = slot.format;
+        for (int arg = 0; arg < DOCK_LOG_MAX_ARGS; ++arg) {
+            entry.args[arg] = slot.args[arg];
+        }
+        entry.level = slot.level;
+        entry.suppressedBefore = slot.suppressedBefore;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence < i + 1) {
+            end = i; // Still being written, picked up by the next flush
+            break;
+        }
+        if (sequence != i + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence || !entry.format) {
+            skipped++;
+            continue;
+        }
+
+        if (!startNs) {
+            startNs = entry.timestampNs;
+        }
+        snprintf(message, sizeof(message), entry.format, (long long)entry.args[0], (long long)entry.args[1],
+                 (long long)entry.args[2], (long long)entry.args[3]);
+
+        // Buffered debug records are written at info level, otherwise OBS would hide them again
+        int level = entry.level > LOG_INFO ? LOG_INFO : entry.level;
+        double offsetMs = (double)(int64_t)(entry.timestampNs - startNs) / 1000000.0;
+        if (entry.suppressedBefore) {
+            blog(level, "  [%+.3f ms] %s (%d similar suppressed)", offsetMs, message, entry.suppressedBefore);
+        } else {
+            blog(level, "  [%+.3f ms] %s", offsetMs, message);
+        }
+    }
+
+    if (skipped) {
+        blog(LOG_INFO, "  (%d records skipped, overwritten while flushing)", skipped);
+    }
+    flushedHead = end;
+}
\ No newline at end of file
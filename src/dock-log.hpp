@@ -0,0 +1,88 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+
+// Most verbose level compiled in, DOCK_LOG calls above it are removed entirely.
+// Build with -DWINDOW_DOCK_LOG_LEVEL=LOG_WARNING to keep only the warnings and errors.
+#ifndef WINDOW_DOCK_LOG_LEVEL
+#define WINDOW_DOCK_LOG_LEVEL LOG_DEBUG
+#endif
+
+constexpr int DOCK_LOG_MAX_ARGS = 4;
+constexpr uint64_t DOCK_LOG_RING_SIZE = 1024; // Power of two
+constexpr int DOCK_LOG_SITE_BURST = 16; // Records a single call site may write per window
+constexpr uint64_t DOCK_LOG_SITE_WINDOW_NS = 1000000000ULL;
+
+
+// A buffered log line: the format literal is kept by pointer and the arguments as raw integers, the
+// text is only built when the buffer is flushed. Formats may therefore only use %lld / %llx.
+// The sequence is published last, a record is only read while it holds the position it was written at.
+struct DockLogRecord {
+    std::atomic<uint64_t> sequence; // Position in the ring plus one, zero while being written
+    uint64_t timestampNs;
+    const char *format;
+    int64_t args[DOCK_LOG_MAX_ARGS];
+    int level;
+    int suppressedBefore; // Records this call site dropped since its previous record
+};
+
+// Rate limit state of one DOCK_LOG call site, which may be hit from the probe pool as well
+struct DockLogSite {
+    std::atomic<uint64_t> windowStartNs = 0;
+    std::atomic<int> written = 0;
+    std::atomic<int> suppressed = 0;
+};
+
+
+// In-memory ring of the most recent debug records. Nothing reaches the OBS log until an error is
+// logged, a flush is requested through the proc handler, or the plugin unloads.
+class DockLog {
+public:
+    static DockLog& instance();
+
+    template <typename... Args>
+    void record(DockLogSite &site, int level, const char *format, Args... args) {
+        static_assert(sizeof...(Args) <= DOCK_LOG_MAX_ARGS, "too many DOCK_LOG arguments");
+        int64_t packed[DOCK_LOG_MAX_ARGS] = {toArg(args)...};
+        write(site, level, format, packed);
+    }
+
+    void flush(const char *reason);
+
+private:
+    DockLog() = default;
+
+    template <typename T>
+    static int64_t toArg(T value) {
+        if constexpr (std::is_pointer_v<T>) {
+            return (int64_t)(intptr_t)value;
+        } else {
+            return (int64_t)value;
+        }
+    }
+
+    void write(DockLogSite &site, int level, const char *format, const int64_t (&args)[DOCK_LOG_MAX_ARGS]);
+
+    DockLogRecord ring[DOCK_LOG_RING_SIZE] = {};
+    std::atomic<uint64_t> head = 0; // Next position to reserve, records up to it may still be in flight
+    uint64_t flushedHead = 0;
+    uint64_t startNs = 0;
+    std::mutex flushMutex;
+};
+
+
+// Logs into the ring buffer. The level is checked at compile time and every call site gets its own
+// rate limit, so this is cheap enough for resize and enumeration paths.
+#define DOCK_LOG(level, format, ...)                                                       \
+    do {                                                                                   \
+        if constexpr ((level) <= WINDOW_DOCK_LOG_LEVEL) {                                  \
+            static DockLogSite dockLogSite;                                                \
+            DockLog::instance().record(dockLogSite, (level), "" format, ##__VA_ARGS__);    \
+        }                                                                                  \
+    } while (0)
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "focus-router.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QApplication>
+#include <QEvent>
+#include <QWidget>
+
+#include <algorithm>
+
+
+FocusRouter& FocusRouter::instance() {
+    static FocusRouter focusRouter;
+    return focusRouter;
+}
+
+void FocusRouter::start() {
+    if (running) {
+        return;
+    }
+
+    qApp->installEventFilter(this);
+    uiThreadId = GetCurrentThreadId();
+    running = true;
+}
+
+void FocusRouter::stop() {
+    if (!running) {
+        return;
+    }
+
+    qApp->removeEventFilter(this);
+    running = false;
+}
+
+// Every Qt window lives on the UI thread, a window pumped by any other thread belongs to an embedded app
+bool FocusRouter::isForeignWindow(HWND hwnd) const {
+    DWORD threadId = GetWindowThreadProcessId(hwnd, nullptr);
+    return threadId != 0 && threadId != uiThreadId;
+}
+
+void FocusRouter::routeClick(HWND container, WPARAM wParam, LPARAM lParam) {
+    WORD childEvent = LOWORD(wParam);
+    if (childEvent != WM_LBUTTONDOWN && childEvent != WM_RBUTTONDOWN && childEvent != WM_MBUTTONDOWN && childEvent != WM_XBUTTONDOWN) {
+        return;
+    }
+
+    // The position is in the container's client coordinates, the direct child under it is the embedded window
+    POINT point = { (short)LOWORD(lParam), (short)HIWORD(lParam) };
+    HWND child = ChildWindowFromPointEx(container, point, CWP_SKIPINVISIBLE | CWP_SKIPTRANSPARENT);
+    if (!child || child == container || !isForeignWindow(child)) {
+        return;
+    }
+
+    focusEmbeddedWindow(child);
+}
+
+void FocusRouter::focusEmbeddedWindow(HWND hwnd) {
+    // The app keeps track of its own focused control, only the handoff from OBS is ours to do
+    HWND focused = GetFocus();
+    if (focused == hwnd || IsChild(hwnd, focused)) {
+        alreadyFocused++;
+        return;
+    }
+
+    uint64_t handoffStart = os_gettime_ns();
+    SetFocus(hwnd);
+    qint64 handoffNs = (qint64)(os_gettime_ns() - handoffStart);
+
+    handoffs++;
+    lastHandoffNs = handoffNs;
+    maxHandoffNs = std::max(maxHandoffNs, handoffNs);
+}
+
+bool FocusRouter::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() != QEvent::MouseButtonPress || !watched->isWidgetType()) {
+        return false;
+    }
+
+    // Qt only sees clicks on its own widgets, so an embedded window holding the focus means the user moved back to OBS
+    HWND focused = GetFocus();
+    if (!focused || !isForeignWindow(focused)) {
+        return false;
+    }
+
+    QWidget *window = static_cast<QWidget*>(watched)->window();
+    SetFocus((HWND)window->winId());
+    returns++;
+    return false;
+}
+
+QJsonObject FocusRouter::toJson() const {
+    QJsonObject focusObject;
+    focusObject["handoffs"] = (qint64)handoffs;
+    focusObject["alreadyFocused"] = (qint64)alreadyFocused;
+    focusObject["returns"] = (qint64)returns;
+    focusObject["lastHandoffUs"] = lastHandoffNs / 1000;
+    focusObject["maxHandoffUs"] = maxHandoffNs / 1000;
+    return focusObject;
+}
\ No newline at end of file
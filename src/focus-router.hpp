@@ -0,0 +1,43 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QJsonObject>
+#include <QObject>
+
+
+// Keyboard focus between OBS and the embedded windows. A click on an embedded window hands it the
+// focus, a click anywhere in OBS takes it back. Reparenting joins the input of the embedded app's
+// thread with OBS's, so a plain SetFocus is enough: no thread input is attached and OBS is never
+// activated along the way.
+class FocusRouter : public QObject {
+    Q_OBJECT
+
+public:
+    static FocusRouter& instance();
+
+    void start();
+    void stop();
+
+    // WM_PARENTNOTIFY of a dock container, the clicked embedded window is looked up from the position
+    void routeClick(HWND container, WPARAM wParam, LPARAM lParam);
+    void focusEmbeddedWindow(HWND hwnd);
+
+    QJsonObject toJson() const;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    FocusRouter() = default;
+
+    bool isForeignWindow(HWND hwnd) const;
+
+    bool running = false;
+    DWORD uiThreadId = 0;
+    quint64 handoffs = 0;
+    quint64 alreadyFocused = 0;
+    quint64 returns = 0;
+    qint64 lastHandoffNs = 0;
+    qint64 maxHandoffNs = 0;
+};
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "frame-impact.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+
+
+FrameImpactMonitor& FrameImpactMonitor::instance() {
+    static FrameImpactMonitor frameImpactMonitor;
+    return frameImpactMonitor;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------SAMPLING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void FrameImpactMonitor::start() {
+    if (running) {
+        return;
+    }
+
+    samples.clear();
+    pendingEvents.clear();
+    totals.clear();
+    baselineFrameTimeSumMs = 0.0;
+    baselineSamples = 0;
+    lastLaggedFrames = obs_get_lagged_frames();
+    lastSkippedFrames = video_output_get_skipped_frames(obs_get_video());
+
+    sampleTimer = new QTimer();
+    sampleTimer->setTimerType(Qt::PreciseTimer);
+    QObject::connect(sampleTimer, &QTimer::timeout, [this]() {
+        takeSample();
+    });
+    sampleTimer->start(FRAME_IMPACT_SAMPLE_INTERVAL_MS);
+    sinceLastSample.start();
+
+    running = true;
+    blog(LOG_INFO, "Frame impact measurement started");
+}
+
+void FrameImpactMonitor::stop() {
+    if (!running) {
+        return;
+    }
+
+    sampleTimer->stop();
+    sampleTimer->deleteLater();
+    sampleTimer = nullptr;
+    running = false;
+    blog(LOG_INFO, "Frame impact measurement stopped after %d samples", (int)samples.size());
+}
+
+void FrameImpactMonitor::recordEvent(FrameImpactEvent event, const QString &dockId) {
+    if (!running) {
+        return;
+    }
+
+    pendingEvents[dockId] |= 1 << event;
+    totals[dockId].events[event]++;
+}
+
+void FrameImpactMonitor::recordAttach(const QString &dockId, HWND hwnd) {
+    // Kept up to date even while not measuring, so resizes of docks attached earlier are attributed too
+    dockByHwnd.insert(hwnd, dockId);
+    recordEvent(FRAME_IMPACT_ATTACH, dockId);
+}
+
+void FrameImpactMonitor::recordRelease(HWND hwnd) {
+    // Handles get reused by Windows, a released one must not keep attributing resizes to its old dock
+    dockByHwnd.remove(hwnd);
+}
+
+void FrameImpactMonitor::recordResize(HWND hwnd) {
+    if (!running) {
+        return;
+    }
+
+    auto dockIter = dockByHwnd.constFind(hwnd);
+    recordEvent(FRAME_IMPACT_RESIZE, dockIter != dockByHwnd.constEnd() ? dockIter.value() : QString());
+}
+
+void FrameImpactMonitor::takeSample() {
+    FrameImpactSample sample;
+    sample.timestampNs = os_gettime_ns();
+    sample.frameTimeNs = obs_get_average_frame_time_ns();
+
+    // The lagged and skipped counters only ever grow, keep the difference since the last sample
+    quint32 laggedFrames = obs_get_lagged_frames();
+    quint32 skippedFrames = video_output_get_skipped_frames(obs_get_video());
+    sample.laggedFrames = laggedFrames - lastLaggedFrames;
+    sample.skippedFrames = skippedFrames - lastSkippedFrames;
+    lastLaggedFrames = laggedFrames;
+    lastSkippedFrames = skippedFrames;
+
+    double elapsedMs = sinceLastSample.nsecsElapsed() / 1000000.0;
+    sinceLastSample.restart();
+    sample.uiLatencyMs = qMax(0.0, elapsedMs - FRAME_IMPACT_SAMPLE_INTERVAL_MS);
+
+    sample.events.swap(pendingEvents);
+
+    double frameTimeMs = sample.frameTimeNs / 1000000.0;
+    if (sample.events.isEmpty()) {
+        baselineFrameTimeSumMs += frameTimeMs;
+        baselineSamples++;
+    }
+
+    for (auto eventIter = sample.events.constBegin(); eventIter != sample.events.constEnd(); ++eventIter) {
+        FrameImpactReport &dockTotals = totals[eventIter.key()];
+        dockTotals.samples++;
+        dockTotals.frameTimeMs += frameTimeMs; // Summed here, averaged in report()
+        dockTotals.laggedFrames += sample.laggedFrames;
+        dockTotals.skippedFrames += sample.skippedFrames;
+        dockTotals.maxUiLatencyMs = qMax(dockTotals.maxUiLatencyMs, sample.uiLatencyMs);
+    }
+
+    samples.push_back(std::move(sample));
+    if (samples.size() > FRAME_IMPACT_MAX_SAMPLES) {
+        samples.pop_front();
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------REPORTING-------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+QList<FrameImpactReport> FrameImpactMonitor::report() const {
+    double baselineMs = baselineSamples ? baselineFrameTimeSumMs / baselineSamples : 0.0;
+
+    QList<FrameImpactReport> reports;
+    for (auto totalsIter = totals.constBegin(); totalsIter != totals.constEnd(); ++totalsIter) {
+        FrameImpactReport dockReport = totalsIter.value();
+        dockReport.dockId = totalsIter.key();
+        dockReport.frameTimeMs = dockReport.samples ? dockReport.frameTimeMs / dockReport.samples : 0.0;
+        dockReport.baselineFrameTimeMs = baselineMs;
+        reports.append(dockReport);
+    }
+
+    std::sort(reports.begin(), reports.end(), [](const FrameImpactReport &a, const FrameImpactReport &b) {
+        return a.dockId < b.dockId;
+    });
+    return reports;
+}
+
+bool FrameImpactMonitor::exportCsv(const QString &filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        blog(LOG_ERROR, "Failed to open frame impact export for writing: %s", filePath.toStdString().c_str());
+        return false;
+    }
+
+    static const char *eventNames[FRAME_IMPACT_EVENT_COUNT] = {"attach", "resize", "enumeration", "apply"};
+
+    // One row per sample, the events column lists "dock:event" pairs separated by spaces
+    QTextStream stream(&file);
+    stream << "timestamp_ms,frame_time_ms,lagged_frames,skipped_frames,ui_latency_ms,events\n";
+
+    quint64 firstTimestampNs = samples.empty() ? 0 : samples.front().timestampNs;
+    for (const FrameImpactSample &sample : samples) {
+        QStringList events;
+        for (auto eventIter = sample.events.constBegin(); eventIter != sample.events.constEnd(); ++eventIter) {
+            QString dockId = eventIter.key().isEmpty() ? QStringLiteral("plugin") : eventIter.key();
+            for (int event = 0; event < FRAME_IMPACT_EVENT_COUNT; ++event) {
+                if (eventIter.value() & (1 << event)) {
+                    events.append(dockId + ':' + eventNames[event]);
+                }
+            }
+        }
+
+        stream << QString::number((sample.timestampNs - firstTimestampNs) / 1000000.0, 'f', 1) << ','
+               << QString::number(sample.frameTimeNs / 1000000.0, 'f', 3) << ','
+               << sample.laggedFrames << ','
+               << sample.skippedFrames << ','
+               << QString::number(sample.uiLatencyMs, 'f', 1) << ','
+               << '"' << events.join(' ') << '"' << '\n';
+    }
+
+    blog(LOG_INFO, "Exported %d frame impact samples to: %s", (int)samples.size(), filePath.toStdString().c_str());
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QTimer>
+
+#include <deque>
+
+
+constexpr int FRAME_IMPACT_SAMPLE_INTERVAL_MS = 100;
+constexpr int FRAME_IMPACT_MAX_SAMPLES = 6000; // Ten minutes of samples kept for the CSV export
+
+
+// Plugin events that samples are attributed to
+enum FrameImpactEvent {
+    FRAME_IMPACT_ATTACH,
+    FRAME_IMPACT_RESIZE,
+    FRAME_IMPACT_ENUMERATION,
+    FRAME_IMPACT_APPLY,
+    FRAME_IMPACT_EVENT_COUNT
+};
+
+// One sample of OBS's health signals, with the plugin events that happened since the previous one
+struct FrameImpactSample {
+    quint64 timestampNs;
+    quint64 frameTimeNs;
+    quint32 laggedFrames; // Since the previous sample
+    quint32 skippedFrames; // Since the previous sample
+    double uiLatencyMs; // How late the sampling timer fired, i.e. how long the UI event loop was blocked
+    QHash<QString, int> events; // Dock ID (empty for plugin-wide work) to a bit per FrameImpactEvent
+};
+
+// Per-dock totals: the samples its events fell into compared with the samples without any plugin activity
+struct FrameImpactReport {
+    QString dockId;
+    int events[FRAME_IMPACT_EVENT_COUNT] = {};
+    int samples = 0;
+    double frameTimeMs = 0.0;
+    double baselineFrameTimeMs = 0.0;
+    quint64 laggedFrames = 0;
+    quint64 skippedFrames = 0;
+    double maxUiLatencyMs = 0.0;
+};
+
+
+// Samples the OBS render and UI frame times while enabled and ties them to dock activity, so a
+// regression in the resize path or in enumeration shows up as a number.
+class FrameImpactMonitor {
+public:
+    static FrameImpactMonitor& instance();
+
+    void start();
+    void stop();
+
+    bool isRunning() const {
+        return running;
+    }
+
+    void recordEvent(FrameImpactEvent event, const QString &dockId = QString());
+    void recordAttach(const QString &dockId, HWND hwnd);
+    void recordRelease(HWND hwnd);
+    void recordResize(HWND hwnd);
+
+    QList<FrameImpactReport> report() const;
+    bool exportCsv(const QString &filePath) const;
+
+private:
+    FrameImpactMonitor() = default;
+
+    void takeSample();
+
+    QTimer *sampleTimer = nullptr;
+    QElapsedTimer sinceLastSample;
+    std::deque<FrameImpactSample> samples;
+    QHash<QString, int> pendingEvents;
+    QHash<HWND, QString> dockByHwnd;
+    QHash<QString, FrameImpactReport> totals;
+    double baselineFrameTimeSumMs = 0.0;
+    int baselineSamples = 0;
+    quint32 lastLaggedFrames = 0;
+    quint32 lastSkippedFrames = 0;
+    bool running = false;
+};
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Shared memory segment with the plugin's live counters, for monitoring tools running next to OBS.
+ *
+ * On Windows the plugin publishes it as the named file mapping METRICS_SEGMENT_NAME once a second
+ * while "publishMetrics" is enabled in settings.json. The layout is a single struct metrics_segment,
+ * native endianness and alignment, checked through magic, version and size.
+ *
+ * Writes are guarded by a seqlock: the plugin makes sequence odd, updates the segment, then makes
+ * it even again, without ever waiting for readers. A reader copies the segment and retries when
+ * sequence was odd or changed during the copy (see metrics_read_segment).
+ */
+
+#define METRICS_SEGMENT_NAME "Local\\obs-window-dock-metrics"
+#define METRICS_FORMAT_MAGIC 0x4D445757u /* "WWDM" */
+#define METRICS_FORMAT_VERSION 1
+#define METRICS_MAX_DOCKS 64
+#define METRICS_DOCK_ID_SIZE 64
+
+enum metrics_dock_state {
+    METRICS_DOCK_SEARCHING = 0,
+    METRICS_DOCK_EMBEDDED = 1,
+    METRICS_DOCK_DETACHED = 2,
+    METRICS_DOCK_LOST = 3,
+    METRICS_DOCK_DEGRADED = 4,
+    METRICS_DOCK_TILED = 5,
+};
+
+struct metrics_dock {
+    char dock_id[METRICS_DOCK_ID_SIZE]; /* UTF-8, NUL terminated, truncated if longer */
+    uint32_t state;                     /* enum metrics_dock_state */
+    uint32_t last_attach_us;            /* Duration of the last attach, 0 if never attached */
+    uint64_t attaches;
+    uint64_t resizes;
+};
+
+struct metrics_segment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                      /* sizeof(struct metrics_segment) */
+    volatile uint32_t sequence;         /* Odd while the plugin is writing */
+    uint64_t publish_time_ns;           /* os_gettime_ns() of the last publish */
+    uint64_t publish_count;
+
+    /* Totals since the plugin was loaded */
+    uint64_t native_calls;
+    uint64_t set_parent_calls;
+    uint64_t set_window_pos_calls;
+    uint64_t enumerations;
+    uint64_t last_enumeration_us;
+    uint64_t max_enumeration_us;
+    uint64_t hung_windows;              /* Docked windows found not responding on exit */
+
+    /* Rates over the last publish interval */
+    double native_calls_per_sec;
+    double resizes_per_sec;
+
+    uint32_t dock_count;
+    uint32_t reserved;
+    struct metrics_dock docks[METRICS_MAX_DOCKS];
+};
+
+#ifdef __cplusplus
+#include <atomic>
+
+/* The sequence is a naturally aligned 32-bit word, which every supported CPU loads and stores
+ * atomically. The fences provide the ordering the seqlock needs around it. */
+
+inline void metrics_begin_write(metrics_segment *segment) {
+    segment->sequence = segment->sequence + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void metrics_end_write(metrics_segment *segment) {
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->sequence = segment->sequence + 1;
+}
+
+/* Copies a consistent snapshot, returns false if the writer kept the segment busy for every attempt */
+inline bool metrics_read_segment(const metrics_segment *segment, metrics_segment *snapshot, int attempts = 1000) {
+    for (int i = 0; i < attempts; ++i) {
+        uint32_t before = segment->sequence;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        memcpy((void*)snapshot, (const void*)segment, sizeof(metrics_segment));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence == before) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "metrics-publisher.hpp"
+
+#include <obs-module.h>
+
+
+MetricsPublisher::~MetricsPublisher() {
+    close();
+}
+
+bool MetricsPublisher::open() {
+    if (segment) {
+        return true;
+    }
+
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(metrics_segment), METRICS_SEGMENT_NAME);
+    if (!mapping) {
+        blog(LOG_ERROR, "Failed to create the metrics segment: %lu", GetLastError());
+        return false;
+    }
+
+    segment = static_cast<metrics_segment*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(metrics_segment)));
+    if (!segment) {
+        blog(LOG_ERROR, "Failed to map the metrics segment: %lu", GetLastError());
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+
+    // A segment left by a previous OBS instance is simply taken over
+    metrics_begin_write(segment);
+    uint32_t sequence = segment->sequence;
+    memset((void*)segment, 0, sizeof(metrics_segment));
+    segment->sequence = sequence;
+    segment->magic = METRICS_FORMAT_MAGIC;
+    segment->version = METRICS_FORMAT_VERSION;
+    segment->size = sizeof(metrics_segment);
+    metrics_end_write(segment);
+
+    blog(LOG_INFO, "Publishing window dock metrics to %s", METRICS_SEGMENT_NAME);
+    return true;
+}
+
+void MetricsPublisher::close() {
+    if (segment) {
+        UnmapViewOfFile(segment);
+        segment = nullptr;
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+}
+
+metrics_segment* MetricsPublisher::beginWrite() {
+    if (segment) {
+        metrics_begin_write(segment);
+    }
+    return segment;
+}
+
+void MetricsPublisher::endWrite() {
+    if (segment) {
+        metrics_end_write(segment);
+    }
+}
\ No newline at end of file
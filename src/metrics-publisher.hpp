@@ -0,0 +1,27 @@
+#pragma once
+
+#include <windows.h>
+
+#include "metrics-format.h"
+
+
+// Owns the named shared memory segment external monitors read the plugin's counters from
+class MetricsPublisher {
+public:
+    ~MetricsPublisher();
+
+    bool open();
+    void close();
+
+    bool isOpen() const {
+        return segment != nullptr;
+    }
+
+    // Brackets an update of the segment, readers retry until the update is complete
+    metrics_segment* beginWrite();
+    void endWrite();
+
+private:
+    HANDLE mapping = nullptr;
+    metrics_segment *segment = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QJsonObject>
+
+#include <atomic>
+
+
+// One running total. The shutdown probe pool releases windows off the UI thread, so the counter is
+// atomic, and a copy is a plain snapshot of its value.
+class NativeCallCounter {
+public:
+    NativeCallCounter(int initialValue = 0) : value(initialValue) {}
+    NativeCallCounter(const NativeCallCounter &other) : value((int)other) {}
+
+    NativeCallCounter& operator=(const NativeCallCounter &other) {
+        value.store((int)other, std::memory_order_relaxed);
+        return *this;
+    }
+
+    int operator++(int) {
+        return value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    NativeCallCounter& operator+=(int amount) {
+        value.fetch_add(amount, std::memory_order_relaxed);
+        return *this;
+    }
+
+    operator int() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> value;
+};
+
+
+// Running totals of the native window and dock calls made by the plugin. An Apply takes a snapshot
+// before and after, so it can report exactly what it cost.
+struct NativeCallCounters {
+    NativeCallCounter findWindow;
+    NativeCallCounter setParent;
+    NativeCallCounter setWindowLong;
+    NativeCallCounter setWindowPos;
+    NativeCallCounter addDock;
+    NativeCallCounter removeDock;
+
+    int total() const {
+        return findWindow + setParent + setWindowLong + setWindowPos + addDock + removeDock;
+    }
+
+    NativeCallCounters operator-(const NativeCallCounters &other) const {
+        NativeCallCounters delta;
+        delta.findWindow = findWindow - other.findWindow;
+        delta.setParent = setParent - other.setParent;
+        delta.setWindowLong = setWindowLong - other.setWindowLong;
+        delta.setWindowPos = setWindowPos - other.setWindowPos;
+        delta.addDock = addDock - other.addDock;
+        delta.removeDock = removeDock - other.removeDock;
+        return delta;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject countersObject;
+        countersObject["findWindow"] = (int)findWindow;
+        countersObject["setParent"] = (int)setParent;
+        countersObject["setWindowLong"] = (int)setWindowLong;
+        countersObject["setWindowPos"] = (int)setWindowPos;
+        countersObject["addDock"] = (int)addDock;
+        countersObject["removeDock"] = (int)removeDock;
+        countersObject["total"] = total();
+        return countersObject;
+    }
+};
+
+inline NativeCallCounters nativeCalls;
\ No newline at end of file
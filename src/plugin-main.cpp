@@ -1,20 +1,50 @@
 #include "plugin-main.hpp"
 #include "window-dock-ui.hpp"
 
-WindowDockUI windowDockUI;
+#include <util/platform.h>
+
+// Created in obs_module_load, a QWidget must not be built during static initialization of the module
+static WindowDockUI *windowDockUI = nullptr;
+
+static void onFrontendEvent(enum obs_frontend_event event, void*) {
+    windowDockUI->onFrontendEvent(event);
+
+    if (event == OBS_FRONTEND_EVENT_EXIT) {
+        // Hotkeys have to be saved and released while libobs is still fully alive
+        windowDockUI->releaseDockHotkeys();
+
+        // Hand the docked windows back while the main window is still around, instead of at unload
+        windowDockUI->releaseWindowsOnExit();
+    }
+}
 
 bool obs_module_load(void) {
+    uint64_t loadStart = os_gettime_ns();
+    windowDockUI = new WindowDockUI();
+
     obs_frontend_add_tools_menu_item(obs_module_text("OBSMenu.CustomWindowDocks"), [](void*){
-        windowDockUI.openCustomWindowDocksUI(nullptr);
+        windowDockUI->openCustomWindowDocksUI(nullptr);
     }, nullptr);
 
-    windowDockUI.restoreDocksOnStartup();
-    blog(LOG_INFO, "Custom Window Docks plugin loaded successfully");
+    obs_frontend_add_event_callback(onFrontendEvent, nullptr);
+    windowDockUI->registerProcHandlers();
+
+    // Docks have to be registered before OBS restores its layout, everything else waits for OBS to finish loading
+    windowDockUI->restoreDocksOnStartup();
+    blog(LOG_INFO, "Custom Window Docks plugin loaded in %.2f ms", (os_gettime_ns() - loadStart) / 1000000.0);
 
     return true;
 }
 
 void obs_module_unload(void) {
-    windowDockUI.freeEmbeddedWindowsOnClose();
+    obs_frontend_remove_event_callback(onFrontendEvent, nullptr);
+    TraceRecorder::instance().stop();
+    FrameImpactMonitor::instance().stop();
+    FocusRouter::instance().stop();
+    windowDockUI->joinReleaseThread();
+    windowDockUI->freeEmbeddedWindowsOnClose();
+    delete windowDockUI;
+    windowDockUI = nullptr;
+    DockLog::instance().flush("unload");
     blog(LOG_INFO, "Custom Window Docks plugin unloaded");
 }
\ No newline at end of file
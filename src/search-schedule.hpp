@@ -0,0 +1,19 @@
+#pragma once
+
+
+// How a dock looks for its window. Shared with the trace replay (tools/trace-replay), so a replayed
+// trace follows the same schedule as the plugin.
+constexpr int WINDOW_SEARCH_ATTEMPTS = 5;
+constexpr int WINDOW_SEARCH_INTERVAL_MS = 6000; // Before the first attempt, doubled for each one after it
+constexpr int WINDOW_SEARCH_MAX_INTERVAL_MS = 30000;
+constexpr int LOST_WINDOW_REMATCH_DELAY_MS = 20; // Coalesces the show and rename events of a reopening app
+
+
+// Delay before a search attempt, without the jitter the plugin adds (TimerWheel::backoffDelay): 6, 12, 24, 30, 30 s
+constexpr int windowSearchDelayMs(int attempt) {
+    int delayMs = WINDOW_SEARCH_INTERVAL_MS;
+    for (int i = 0; i < attempt && delayMs < WINDOW_SEARCH_MAX_INTERVAL_MS; ++i) {
+        delayMs *= 2;
+    }
+    return delayMs < WINDOW_SEARCH_MAX_INTERVAL_MS ? delayMs : WINDOW_SEARCH_MAX_INTERVAL_MS;
+}
\ No newline at end of file
@@ -0,0 +1,530 @@
+#include "stress-harness.hpp"
+#include "window-dock-ui.hpp"
+
+#include <util/platform.h>
+
+#include <QApplication>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+
+constexpr const wchar_t* STRESS_WINDOW_CLASS = L"WindowDockStressWindow";
+constexpr int STRESS_CHURN_INTERVAL_MS = 50;
+constexpr int STRESS_SPAWN_TIMEOUT_MS = 10000;
+constexpr int STRESS_MAX_REPORTED_FAILURES = 20;
+constexpr int STRESS_KEYSTROKE_TIMEOUT_MS = 1000;
+constexpr WORD STRESS_PROBE_KEY = 0xE8; // Unassigned virtual key, harmless wherever it lands
+
+// Synthetic window count and run size, each option can be overridden by the caller within these limits
+constexpr int STRESS_DEFAULT_WINDOWS = 200;
+constexpr int STRESS_MAX_WINDOWS = 1000;
+constexpr int STRESS_DEFAULT_DOCKS = 24;
+constexpr int STRESS_MAX_DOCKS = 64;
+constexpr int STRESS_DEFAULT_ENUMERATIONS = 50;
+constexpr int STRESS_DEFAULT_RESIZES = 20;
+constexpr int STRESS_DEFAULT_CYCLES = 10;
+constexpr int STRESS_DEFAULT_CLICKS = 20;
+constexpr int STRESS_DEFAULT_FILTERS = 20;
+
+// The window picker's filter has to keep up with typing at this many windows
+constexpr int STRESS_PICKER_WINDOWS = 2000;
+constexpr qint64 STRESS_FILTER_BUDGET_NS = 1000000;
+constexpr int STRESS_MAX_ITERATIONS = 1000;
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*------------------------------------SYNTHETIC WINDOWS--------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+// The last probe keystroke a synthetic window received, written on the window thread
+static std::atomic<HWND> probeKeyWindow{nullptr};
+static std::atomic<uint64_t> probeKeyNs{0};
+
+LRESULT CALLBACK StressHarness::windowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == WM_KEYDOWN && wParam == STRESS_PROBE_KEY) {
+        probeKeyNs = os_gettime_ns();
+        probeKeyWindow = hwnd;
+        return 0;
+    }
+    return DefWindowProcW(hwnd, msg, wParam, lParam);
+}
+
+QString StressHarness::windowTitle(int index) {
+    return QString("Window Dock Stress %1").arg(index);
+}
+
+// Picker rows only, no native window behind them. The handles are never dereferenced, the list model
+// only uses them to tell rows apart.
+std::vector<WindowInfo> StressHarness::pickerWindows(int count) {
+    static const char *executables[] = {"chrome.exe", "firefox.exe", "Code.exe", "Discord.exe", "Spotify.exe", "explorer.exe", "notepad.exe", "obs64.exe"};
+
+    std::vector<WindowInfo> windows;
+    windows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        WindowInfo window = {};
+        window.hwnd = reinterpret_cast<HWND>((quintptr)(i + 1));
+        window.executable = executables[i % std::size(executables)];
+        window.executablePath = QString("C:\\Program Files\\%1").arg(window.executable);
+        window.title = QString("%1 - Stress Picker %2").arg(windowTitle(i)).arg(i % 97);
+        windows.push_back(window);
+    }
+    return windows;
+}
+
+// The windows live on their own thread with its own message loop, like the windows of another app.
+// Windows past churnFrom are renamed all the time, so enumeration never sees the same list twice.
+void StressHarness::windowThreadMain(int count, int churnFrom) {
+    windowThreadId = GetCurrentThreadId();
+
+    WNDCLASSW windowClass = {};
+    windowClass.lpfnWndProc = windowProc;
+    windowClass.hInstance = GetModuleHandleW(nullptr);
+    windowClass.lpszClassName = STRESS_WINDOW_CLASS;
+    RegisterClassW(&windowClass);
+
+    windows.clear();
+    windows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString title = windowTitle(i);
+        HWND hwnd = CreateWindowExW(0, STRESS_WINDOW_CLASS, reinterpret_cast<LPCWSTR>(title.utf16()), WS_OVERLAPPEDWINDOW,
+                                    CW_USEDEFAULT, CW_USEDEFAULT, 320, 240, nullptr, nullptr, windowClass.hInstance, nullptr);
+        if (hwnd) {
+            windows.push_back(hwnd);
+        }
+    }
+
+    UINT_PTR churnTimer = SetTimer(nullptr, 0, STRESS_CHURN_INTERVAL_MS, nullptr);
+    windowsReady = true;
+
+    quint64 generation = 0;
+    MSG msg;
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+        if (msg.message == WM_TIMER && msg.hwnd == nullptr) {
+            generation++;
+            for (int i = churnFrom; i < (int)windows.size(); ++i) {
+                QString title = QString("%1 (%2)").arg(windowTitle(i)).arg(generation);
+                SetWindowTextW(windows[i], reinterpret_cast<LPCWSTR>(title.utf16()));
+                titleChanges++;
+            }
+            continue;
+        }
+
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+
+    KillTimer(nullptr, churnTimer);
+    for (HWND hwnd : windows) {
+        DestroyWindow(hwnd);
+    }
+    UnregisterClassW(STRESS_WINDOW_CLASS, windowClass.hInstance);
+}
+
+bool StressHarness::spawnWindows(int count, int churnFrom) {
+    windowsReady = false;
+    windowThread = std::thread(&StressHarness::windowThreadMain, this, count, churnFrom);
+
+    QElapsedTimer spawnTimer;
+    spawnTimer.start();
+    while (!windowsReady && spawnTimer.elapsed() < STRESS_SPAWN_TIMEOUT_MS) {
+        QThread::msleep(5);
+    }
+    return windowsReady;
+}
+
+void StressHarness::destroyWindows() {
+    if (!windowThread.joinable()) {
+        return;
+    }
+
+    // The thread may not have its message queue yet, retry until the quit message is posted
+    while (!PostThreadMessageW(windowThreadId, WM_QUIT, 0, 0)) {
+        QThread::msleep(5);
+    }
+    windowThread.join();
+    windows.clear();
+}
+
+void StressHarness::checkEmbedded(const QString &phase, const QString &dockId, int windowIndex) {
+    EmbeddedWindowWidget *dockWidget = windowDockUI.activeDocks.value(dockId, nullptr);
+    HWND expected = windowIndex < (int)windows.size() ? windows[windowIndex] : nullptr;
+    if (dockWidget && dockWidget->getState() == DockState::Embedded && dockWidget->getEmbeddedHwnd() == expected) {
+        return;
+    }
+
+    failureCount++;
+    if (failures.size() < STRESS_MAX_REPORTED_FAILURES) {
+        failures.append(QString("%1: dock %2 did not embed %3").arg(phase, dockId, windowTitle(windowIndex)));
+    }
+    blog(LOG_ERROR, "Stress run: %s of dock %s did not embed its window", phase.toStdString().c_str(), dockId.toStdString().c_str());
+}
+
+// Clicks into the embedded window through the real input path and types the probe key right after it,
+// like a user who clicks an app and starts typing. The keystroke only reaches the window if the click
+// handed it the focus. Returns the nanoseconds from the click to the keystroke, or -1.
+qint64 StressHarness::clickAndType(const QString &dockId, int windowIndex) {
+    EmbeddedWindowWidget *dockWidget = windowDockUI.activeDocks.value(dockId, nullptr);
+    QDockWidget *frame = windowDockUI.getDockFrame(dockId);
+    HWND target = windowIndex < (int)windows.size() ? windows[windowIndex] : nullptr;
+    if (!dockWidget || !frame || !target || dockWidget->getEmbeddedHwnd() != target) {
+        return -1;
+    }
+
+    // Bring the dock on top and give the focus back to OBS, so every click is a real handoff
+    frame->raise();
+    frame->activateWindow();
+    settle();
+    SetFocus((HWND)frame->window()->winId());
+
+    RECT rect;
+    GetWindowRect(target, &rect);
+    POINT center = { (rect.left + rect.right) / 2, (rect.top + rect.bottom) / 2 };
+    if (WindowFromPoint(center) != target) {
+        blog(LOG_WARNING, "Stress run: the window of dock %s is covered, it cannot be clicked", dockId.toStdString().c_str());
+        return -1;
+    }
+
+    POINT savedCursor;
+    GetCursorPos(&savedCursor);
+    SetCursorPos(center.x, center.y);
+
+    INPUT inputs[4] = {};
+    inputs[0].type = INPUT_MOUSE;
+    inputs[0].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
+    inputs[1].type = INPUT_MOUSE;
+    inputs[1].mi.dwFlags = MOUSEEVENTF_LEFTUP;
+    inputs[2].type = INPUT_KEYBOARD;
+    inputs[2].ki.wVk = STRESS_PROBE_KEY;
+    inputs[3].type = INPUT_KEYBOARD;
+    inputs[3].ki.wVk = STRESS_PROBE_KEY;
+    inputs[3].ki.dwFlags = KEYEVENTF_KEYUP;
+
+    probeKeyWindow = nullptr;
+    uint64_t start = os_gettime_ns();
+    UINT sent = SendInput(4, inputs, sizeof(INPUT));
+
+    // The click is routed by the UI thread (WM_PARENTNOTIFY of the dock), so it keeps pumping while waiting
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    while (sent == 4 && probeKeyWindow != target && waitTimer.elapsed() < STRESS_KEYSTROKE_TIMEOUT_MS) {
+        QApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+
+    SetCursorPos(savedCursor.x, savedCursor.y);
+    return probeKeyWindow == target ? (qint64)(probeKeyNs - start) : -1;
+}
+
+// Lets queued and deferred work of the previous step run, so it is counted where it belongs
+void StressHarness::settle() {
+    QApplication::processEvents();
+    QApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------------REPORT--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+qint64 StressHarness::Series::percentileNs(double percentile) {
+    if (samplesNs.empty()) {
+        return 0;
+    }
+
+    std::sort(samplesNs.begin(), samplesNs.end());
+    size_t index = std::min(samplesNs.size() - 1, (size_t)(percentile * samplesNs.size()));
+    return samplesNs[index];
+}
+
+QJsonObject StressHarness::Series::toJson() {
+    auto percentileUs = [this](double percentile) -> qint64 {
+        return percentileNs(percentile) / 1000;
+    };
+
+    QJsonObject seriesObject;
+    seriesObject["count"] = (qint64)samplesNs.size();
+    seriesObject["totalMs"] = totalNs / 1000000.0;
+    seriesObject["perSecond"] = totalNs > 0 ? samplesNs.size() * 1000000000.0 / totalNs : 0.0;
+    seriesObject["p50Us"] = percentileUs(0.50);
+    seriesObject["p95Us"] = percentileUs(0.95);
+    seriesObject["p99Us"] = percentileUs(0.99);
+    seriesObject["maxUs"] = samplesNs.empty() ? 0 : samplesNs.back() / 1000;
+    return seriesObject;
+}
+
+StressHarness::ResourceSnapshot StressHarness::captureResources() const {
+    ResourceSnapshot snapshot;
+    snapshot.userObjects = GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS);
+    snapshot.gdiObjects = GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS);
+    snapshot.widgets = QApplication::allWidgets().size();
+    snapshot.pendingTimers = windowDockUI.timerWheel.toJson()["pending"].toInt();
+    snapshot.docks = windowDockUI.activeDocks.size() + windowDockUI.tiledDocks.size();
+    return snapshot;
+}
+
+StressHarness::ResourceSnapshot StressHarness::ResourceSnapshot::operator-(const ResourceSnapshot &other) const {
+    ResourceSnapshot delta;
+    delta.userObjects = userObjects - other.userObjects;
+    delta.gdiObjects = gdiObjects - other.gdiObjects;
+    delta.widgets = widgets - other.widgets;
+    delta.pendingTimers = pendingTimers - other.pendingTimers;
+    delta.docks = docks - other.docks;
+    return delta;
+}
+
+QJsonObject StressHarness::ResourceSnapshot::toJson() const {
+    QJsonObject resourcesObject;
+    resourcesObject["userObjects"] = userObjects;
+    resourcesObject["gdiObjects"] = gdiObjects;
+    resourcesObject["widgets"] = widgets;
+    resourcesObject["pendingTimers"] = pendingTimers;
+    resourcesObject["docks"] = docks;
+    return resourcesObject;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------------PHASES--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+QJsonObject StressHarness::run(const QJsonObject &options) {
+    int windowCount = std::clamp(options["windows"].toInt(STRESS_DEFAULT_WINDOWS), 1, STRESS_MAX_WINDOWS);
+    int dockCount = std::clamp(options["docks"].toInt(STRESS_DEFAULT_DOCKS), 1, std::min(STRESS_MAX_DOCKS, windowCount));
+    int enumerations = std::clamp(options["enumerations"].toInt(STRESS_DEFAULT_ENUMERATIONS), 0, STRESS_MAX_ITERATIONS);
+    int resizes = std::clamp(options["resizes"].toInt(STRESS_DEFAULT_RESIZES), 0, STRESS_MAX_ITERATIONS);
+    int cycles = std::clamp(options["cycles"].toInt(STRESS_DEFAULT_CYCLES), 0, STRESS_MAX_ITERATIONS);
+    int clicks = std::clamp(options["clicks"].toInt(STRESS_DEFAULT_CLICKS), 0, STRESS_MAX_ITERATIONS);
+    int filters = std::clamp(options["filters"].toInt(STRESS_DEFAULT_FILTERS), 0, STRESS_MAX_ITERATIONS);
+
+    QJsonObject reportObject;
+    failures = QJsonArray();
+    failureCount = 0;
+    settle();
+    ResourceSnapshot before = captureResources();
+    NativeCallCounters callsBefore = nativeCalls;
+    QElapsedTimer runTimer;
+    runTimer.start();
+
+    // Spare windows are the ones not docked, a retarget moves a dock over to one of them
+    int spareFrom = dockCount;
+    int churnFrom = std::min(windowCount, dockCount * 2);
+
+    // The synthetic windows belong to the OBS process, which the registry leaves out by default
+    WindowFilterSettings savedFilterSettings = windowDockUI.windowRegistry.getFilterSettings();
+    WindowFilterSettings stressFilterSettings = savedFilterSettings;
+    stressFilterSettings.skipOwnProcess = false;
+    windowDockUI.windowRegistry.setFilterSettings(stressFilterSettings);
+
+    if (!spawnWindows(windowCount, churnFrom)) {
+        destroyWindows();
+        windowDockUI.windowRegistry.setFilterSettings(savedFilterSettings);
+        reportObject["ok"] = false;
+        reportObject["error"] = "Synthetic windows were not created in time";
+        return reportObject;
+    }
+
+    Series enumerationSeries{"enumeration"};
+    for (int i = 0; i < enumerations; ++i) {
+        uint64_t start = os_gettime_ns();
+        windowDockUI.windowRegistry.refresh();
+        enumerationSeries.add((qint64)(os_gettime_ns() - start));
+    }
+
+    QStringList dockIdList;
+    for (int i = 0; i < dockCount; ++i) {
+        dockIdList.append(QString("window_dock_stress_%1").arg(i));
+    }
+
+    // Creating a dock covers adding it to OBS, showing it and embedding its window on first show
+    Series createSeries{"create"};
+    for (int i = 0; i < dockCount; ++i) {
+        const QString &dockId = dockIdList[i];
+        uint64_t start = os_gettime_ns();
+        windowDockUI.createDockContent(dockId, dockId, windowTitle(i));
+        if (QDockWidget *frame = windowDockUI.getDockFrame(dockId)) {
+            frame->show();
+        }
+        QApplication::processEvents();
+        createSeries.add((qint64)(os_gettime_ns() - start));
+
+        checkEmbedded("create", dockId, i);
+    }
+
+    int embeddedCount = 0;
+    for (const QString &dockId : dockIdList) {
+        EmbeddedWindowWidget *dockWidget = windowDockUI.activeDocks.value(dockId, nullptr);
+        if (dockWidget && dockWidget->getState() == DockState::Embedded) {
+            embeddedCount++;
+        }
+    }
+
+    Series resizeSeries{"resize"};
+    for (int i = 0; i < resizes; ++i) {
+        for (const QString &dockId : dockIdList) {
+            EmbeddedWindowWidget *dockWidget = windowDockUI.activeDocks.value(dockId, nullptr);
+            if (!dockWidget) {
+                continue;
+            }
+
+            uint64_t start = os_gettime_ns();
+            dockWidget->resize(240 + (i % 2) * 80, 180 + (i % 2) * 60);
+            resizeSeries.add((qint64)(os_gettime_ns() - start));
+        }
+    }
+
+    // Click-to-keystroke goes through the real input queue, so it moves the cursor of the test machine
+    Series keystrokeSeries{"clickToKeystroke"};
+    for (int i = 0; i < clicks; ++i) {
+        int dockIndex = i % dockCount;
+        const QString &dockId = dockIdList[dockIndex];
+        qint64 latencyNs = clickAndType(dockId, dockIndex);
+        if (latencyNs >= 0) {
+            keystrokeSeries.add(latencyNs);
+            continue;
+        }
+
+        failureCount++;
+        if (failures.size() < STRESS_MAX_REPORTED_FAILURES) {
+            failures.append(QString("clickToKeystroke: the window of dock %1 did not get the keystroke").arg(dockId));
+        }
+        blog(LOG_ERROR, "Stress run: the window of dock %s did not get the keystroke after a click", dockId.toStdString().c_str());
+    }
+
+    // The picker's filter, typed one character at a time and erased again, as a user looking for a window does
+    Series filterSeries{"filterKeystroke"};
+    if (filters > 0) {
+        WindowListModel listModel(windowDockUI.appIconCache, 16);
+        listModel.update(pickerWindows(STRESS_PICKER_WINDOWS));
+        WindowFilterModel filterModel(&listModel);
+
+        const QString queries[] = {"stress 1999", "chrome", "cdstr", "picker 42"};
+        for (int i = 0; i < filters; ++i) {
+            const QString &query = queries[i % std::size(queries)];
+            for (int length = 1; length <= query.size(); ++length) {
+                uint64_t start = os_gettime_ns();
+                filterModel.setFilterText(query.left(length));
+                filterSeries.add((qint64)(os_gettime_ns() - start));
+            }
+            for (int length = query.size() - 1; length >= 0; --length) {
+                uint64_t start = os_gettime_ns();
+                filterModel.setFilterText(query.left(length));
+                filterSeries.add((qint64)(os_gettime_ns() - start));
+            }
+        }
+
+        qint64 filterP99Ns = filterSeries.percentileNs(0.99);
+        if (filterP99Ns > STRESS_FILTER_BUDGET_NS) {
+            failureCount++;
+            failures.append(QString("filterKeystroke: p99 of %1 us at %2 windows is over budget").arg(filterP99Ns / 1000).arg(STRESS_PICKER_WINDOWS));
+            blog(LOG_ERROR, "Stress run: filtering %d windows took %lld us per keystroke (p99)", STRESS_PICKER_WINDOWS, filterP99Ns / 1000);
+        }
+    }
+
+    Series detachSeries{"detach"};
+    Series reembedSeries{"reembed"};
+    for (int i = 0; i < cycles; ++i) {
+        for (int dockIndex = 0; dockIndex < dockCount; ++dockIndex) {
+            const QString &dockId = dockIdList[dockIndex];
+            uint64_t start = os_gettime_ns();
+            windowDockUI.detachEmbeddedWindow(dockId);
+            detachSeries.add((qint64)(os_gettime_ns() - start));
+
+            start = os_gettime_ns();
+            bool reembedded = windowDockUI.reembedWindow(dockId);
+            reembedSeries.add((qint64)(os_gettime_ns() - start));
+
+            if (!reembedded) {
+                blog(LOG_ERROR, "Stress run: reembed of dock %s failed", dockId.toStdString().c_str());
+            }
+            checkEmbedded("reembed", dockId, dockIndex);
+        }
+    }
+
+    // The live part of an Apply: renames and retargets, alternating between two windows per dock
+    Series applySeries{"apply"};
+    for (int i = 0; i < cycles; ++i) {
+        for (int dockIndex = 0; dockIndex < dockCount; ++dockIndex) {
+            const QString &dockId = dockIdList[dockIndex];
+            int windowIndex = (i % 2 == 0 && spareFrom + dockIndex < churnFrom) ? spareFrom + dockIndex : dockIndex;
+
+            uint64_t start = os_gettime_ns();
+            windowDockUI.renameDock(dockId, QString("%1 %2").arg(dockId).arg(i));
+            windowDockUI.retargetDock(dockId, windowTitle(windowIndex));
+            applySeries.add((qint64)(os_gettime_ns() - start));
+
+            checkEmbedded("retarget", dockId, windowIndex);
+        }
+    }
+
+    Series removeSeries{"remove"};
+    for (const QString &dockId : dockIdList) {
+        uint64_t start = os_gettime_ns();
+        windowDockUI.removeDock(dockId, false);
+        removeSeries.add((qint64)(os_gettime_ns() - start));
+    }
+
+    destroyWindows();
+    windowDockUI.windowRegistry.setFilterSettings(savedFilterSettings);
+    settle();
+
+    ResourceSnapshot after = captureResources();
+    ResourceSnapshot leaked = after - before;
+    NativeCallCounters calls = nativeCalls - callsBefore;
+
+    // Whatever the run left behind fails it like a missed check. GDI objects are only reported, caches
+    // hold on to some of them between runs.
+    const std::pair<const char*, qint64> leaks[] = {
+        {"user objects", leaked.userObjects}, {"widgets", leaked.widgets}, {"timers", leaked.pendingTimers}, {"docks", leaked.docks}};
+    for (const auto &[resource, count] : leaks) {
+        if (count <= 0) {
+            continue;
+        }
+        failureCount++;
+        if (failures.size() < STRESS_MAX_REPORTED_FAILURES) {
+            failures.append(QString("leak: %1 %2 left behind").arg(count).arg(resource));
+        }
+    }
+
+    QJsonObject seriesObject;
+    for (Series *series : {&enumerationSeries, &createSeries, &resizeSeries, &keystrokeSeries, &filterSeries, &detachSeries, &reembedSeries, &applySeries, &removeSeries}) {
+        seriesObject[series->name] = series->toJson();
+    }
+
+    reportObject["ok"] = failureCount == 0;
+    reportObject["failed"] = failureCount;
+    reportObject["failures"] = failures;
+    reportObject["windows"] = windowCount;
+    reportObject["docks"] = dockCount;
+    reportObject["embedded"] = embeddedCount;
+    reportObject["titleChanges"] = (qint64)titleChanges.load();
+    reportObject["durationMs"] = runTimer.elapsed();
+    reportObject["operations"] = seriesObject;
+    reportObject["nativeCalls"] = calls.toJson();
+    reportObject["resourcesBefore"] = before.toJson();
+    reportObject["resourcesAfter"] = after.toJson();
+    reportObject["leaked"] = leaked.toJson();
+
+    blog(failureCount > 0 ? LOG_WARNING : LOG_INFO,
+         "Stress run: %d windows, %d of %d docks embedded, %d failed checks, %lld ms; left behind %lld user objects, %lld GDI objects, "
+         "%lld widgets, %lld timers, %lld docks",
+         windowCount, embeddedCount, dockCount, failureCount, runTimer.elapsed(), leaked.userObjects, leaked.gdiObjects, leaked.widgets,
+         leaked.pendingTimers, leaked.docks);
+
+    return reportObject;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "window-registry.hpp"
+
+
+class WindowDockUI;
+
+// Drives the real dock code paths against hundreds of synthetic windows and reports throughput,
+// tail latencies and the native resources left behind. Only built with ENABLE_STRESS_HARNESS, it
+// is meant for release checks on a test machine: the docks it creates show up in OBS while it runs.
+class StressHarness {
+public:
+    explicit StressHarness(WindowDockUI &windowDockUI)
+        : windowDockUI(windowDockUI) {}
+
+    QJsonObject run(const QJsonObject &options);
+
+private:
+    // Latencies of one kind of operation
+    struct Series {
+        QString name;
+        std::vector<qint64> samplesNs;
+        qint64 totalNs = 0;
+
+        void add(qint64 ns) {
+            samplesNs.push_back(ns);
+            totalNs += ns;
+        }
+
+        qint64 percentileNs(double percentile);
+        QJsonObject toJson();
+    };
+
+    // What a run must give back: window and GDI handles, widgets, pending timers and docks
+    struct ResourceSnapshot {
+        qint64 userObjects = 0;
+        qint64 gdiObjects = 0;
+        qint64 widgets = 0;
+        qint64 pendingTimers = 0;
+        qint64 docks = 0;
+
+        QJsonObject toJson() const;
+        ResourceSnapshot operator-(const ResourceSnapshot &other) const;
+    };
+
+    ResourceSnapshot captureResources() const;
+
+    // Every embed, reembed and retarget is checked, a run that only timed failures is no measurement
+    void checkEmbedded(const QString &phase, const QString &dockId, int windowIndex);
+
+    bool spawnWindows(int count, int churnFrom);
+    void destroyWindows();
+    void windowThreadMain(int count, int churnFrom);
+    static LRESULT CALLBACK windowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+    qint64 clickAndType(const QString &dockId, int windowIndex);
+    static QString windowTitle(int index);
+    static std::vector<WindowInfo> pickerWindows(int count);
+    static void settle();
+
+    WindowDockUI &windowDockUI;
+    std::thread windowThread;
+    std::vector<HWND> windows; // Written by the window thread before windowsReady is set
+    QJsonArray failures;
+    int failureCount = 0;
+    std::atomic<DWORD> windowThreadId{0};
+    std::atomic<bool> windowsReady{false};
+    std::atomic<quint64> titleChanges{0};
+};
\ No newline at end of file
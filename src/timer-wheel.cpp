@@ -0,0 +1,227 @@
+#include "timer-wheel.hpp"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*--------------------------------------SCHEDULING-------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+TimerId TimerWheel::schedule(int delayMs, std::function<void()> task, QObject *context, int coalesceMs) {
+    if (!clock.isValid()) {
+        clock.start();
+    }
+
+    // An idle wheel catches up with the clock here. A busy one does that on its next wakeup, so no
+    // task ever runs from inside schedule().
+    if (pendingSlots.isEmpty()) {
+        currentTick = std::max(currentTick, now());
+    }
+
+    quint64 deadlineMs = clock.elapsed() + (quint64)std::max(delayMs, 0);
+    if (coalesceMs > 0) {
+        deadlineMs = (deadlineMs + coalesceMs - 1) / coalesceMs * coalesceMs;
+    }
+
+    // Round up to a whole tick, nothing ever runs early
+    quint64 deadlineTick = std::max((deadlineMs + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS, currentTick + 1);
+
+    TimerId id = nextId++;
+    insert(Entry{id, deadlineTick, std::move(task), QPointer<QObject>(context), context != nullptr});
+
+    rearm();
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    auto slotIter = pendingSlots.find(id);
+    if (slotIter == pendingSlots.end()) {
+        return false;
+    }
+
+    // Unlinked right away, so a slot that only held cancelled entries never causes a wakeup. An entry
+    // taken out of its slot by a running advance() is not found there, and skipped for its missing ID.
+    std::vector<Entry> &slot = slotAt(slotIter.value());
+    slot.erase(std::remove_if(slot.begin(), slot.end(), [id](const Entry &entry) {
+        return entry.id == id;
+    }), slot.end());
+    pendingSlots.erase(slotIter);
+
+    rearm();
+    return true;
+}
+
+void TimerWheel::stop() {
+    pendingSlots.clear();
+    for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+        innerWheel[slot].clear();
+        outerWheel[slot].clear();
+    }
+
+    delete timer;
+    timer = nullptr;
+}
+
+int TimerWheel::backoffDelay(int baseMs, int attempt, int maxMs) {
+    qint64 delayMs = baseMs;
+    for (int i = 0; i < attempt && delayMs < maxMs; ++i) {
+        delayMs *= 2;
+    }
+    delayMs = std::min<qint64>(delayMs, maxMs);
+
+    int jitterMs = (int)(delayMs / 10);
+    if (jitterMs > 0) {
+        delayMs += QRandomGenerator::global()->bounded(-jitterMs, jitterMs + 1);
+    }
+    return (int)delayMs;
+}
+
+quint64 TimerWheel::now() const {
+    return clock.elapsed() / TIMER_WHEEL_TICK_MS;
+}
+
+std::vector<TimerWheel::Entry>& TimerWheel::slotAt(int slotIndex) {
+    return slotIndex < TIMER_WHEEL_SLOTS ? innerWheel[slotIndex] : outerWheel[slotIndex - TIMER_WHEEL_SLOTS];
+}
+
+void TimerWheel::insert(Entry &&entry) {
+    quint64 ticksAhead = entry.deadlineTick - currentTick;
+
+    int slotIndex;
+    if (ticksAhead < TIMER_WHEEL_SLOTS) {
+        slotIndex = (int)(entry.deadlineTick % TIMER_WHEEL_SLOTS);
+    } else if (ticksAhead < (quint64)TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS) {
+        slotIndex = TIMER_WHEEL_SLOTS + (int)((entry.deadlineTick / TIMER_WHEEL_SLOTS) % TIMER_WHEEL_SLOTS);
+    } else {
+        // Beyond the outer wheel: park it in the furthest outer slot, it is placed again on cascade
+        slotIndex = TIMER_WHEEL_SLOTS + (int)((currentTick / TIMER_WHEEL_SLOTS + TIMER_WHEEL_SLOTS - 1) % TIMER_WHEEL_SLOTS);
+    }
+
+    pendingSlots.insert(entry.id, slotIndex);
+    slotAt(slotIndex).push_back(std::move(entry));
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*----------------------------------------RUNNING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void TimerWheel::advance() {
+    quint64 targetTick = now();
+
+    // While idle the wheel just jumps ahead, there is nothing in the slots it skips
+    if (pendingSlots.isEmpty()) {
+        currentTick = std::max(currentTick, targetTick);
+        return;
+    }
+
+    while (currentTick < targetTick) {
+        currentTick++;
+
+        // Entering a new outer slot moves its entries down into the inner wheel
+        if (currentTick % TIMER_WHEEL_SLOTS == 0) {
+            std::vector<Entry> cascading;
+            cascading.swap(outerWheel[(currentTick / TIMER_WHEEL_SLOTS) % TIMER_WHEEL_SLOTS]);
+            for (Entry &entry : cascading) {
+                if (pendingSlots.contains(entry.id)) {
+                    insert(std::move(entry));
+                }
+            }
+        }
+
+        std::vector<Entry> due;
+        due.swap(innerWheel[currentTick % TIMER_WHEEL_SLOTS]);
+        for (Entry &entry : due) {
+            if (!pendingSlots.contains(entry.id)) {
+                continue;
+            }
+            if (entry.deadlineTick > currentTick) {
+                insert(std::move(entry));
+                continue;
+            }
+
+            pendingSlots.remove(entry.id);
+            if (entry.hasContext && !entry.context) {
+                continue;
+            }
+            tasksRun++;
+            entry.task();
+        }
+    }
+}
+
+void TimerWheel::rearm() {
+    if (pendingSlots.isEmpty()) {
+        if (timer) {
+            timer->stop();
+        }
+        return;
+    }
+
+    // Sleep until the next inner slot with work, or until the next cascade if that comes first
+    quint64 nextTick = 0;
+    for (quint64 tick = currentTick + 1; tick <= currentTick + TIMER_WHEEL_SLOTS; ++tick) {
+        if (!innerWheel[tick % TIMER_WHEEL_SLOTS].empty()) {
+            nextTick = tick;
+            break;
+        }
+    }
+
+    quint64 cascadeTick = (currentTick / TIMER_WHEEL_SLOTS + 1) * TIMER_WHEEL_SLOTS;
+    bool outerBusy = std::any_of(std::begin(outerWheel), std::end(outerWheel), [](const std::vector<Entry> &slot) {
+        return !slot.empty();
+    });
+    if (!nextTick || (outerBusy && cascadeTick < nextTick)) {
+        nextTick = cascadeTick;
+    }
+
+    if (!timer) {
+        timer = new QTimer();
+        timer->setSingleShot(true);
+        QObject::connect(timer, &QTimer::timeout, [this]() {
+            wakeups++;
+            rateWindowWakeups++;
+            quint64 elapsedMs = clock.elapsed();
+            if (elapsedMs - rateWindowStartMs >= 1000) {
+                lastWakeupRate = rateWindowWakeups * 1000.0 / (elapsedMs - rateWindowStartMs);
+                rateWindowStartMs = elapsedMs;
+                rateWindowWakeups = 0;
+            }
+
+            advance();
+            rearm();
+        });
+    }
+
+    qint64 sleepMs = (qint64)(nextTick * TIMER_WHEEL_TICK_MS) - clock.elapsed();
+    timer->start((int)std::max<qint64>(sleepMs, 0));
+}
+
+double TimerWheel::wakeupsPerSecond() const {
+    // A wheel that has gone quiet reports zero rather than its last busy second
+    if (!clock.isValid() || (quint64)clock.elapsed() - rateWindowStartMs > 2000) {
+        return 0.0;
+    }
+    return lastWakeupRate;
+}
+
+QJsonObject TimerWheel::toJson() const {
+    return QJsonObject{
+        {"pending", (int)pendingSlots.size()},
+        {"wakeups", (qint64)wakeups},
+        {"wakeupsPerSecond", wakeupsPerSecond()},
+        {"tasksRun", (qint64)tasksRun}
+    };
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QTimer>
+
+#include <functional>
+#include <vector>
+
+
+constexpr int TIMER_WHEEL_TICK_MS = 100;
+constexpr int TIMER_WHEEL_SLOTS = 64; // Per level, the outer level covers 64 * 64 ticks (about seven minutes)
+
+using TimerId = quint64;
+
+
+// One timer for all of the plugin's delayed and periodic work. Deadlines are kept in a two level
+// hashed wheel, and the driving timer only wakes up for ticks that have something due. It stops
+// entirely while nothing is pending, so an idle plugin never wakes the UI thread.
+class TimerWheel {
+public:
+    // Runs task once, roughly delayMs from now. With a coalesce window the deadline is rounded up
+    // to a multiple of it, so work scheduled around the same time runs on the same wakeup. Tasks
+    // with a context are dropped when the context is destroyed first.
+    TimerId schedule(int delayMs, std::function<void()> task, QObject *context = nullptr, int coalesceMs = 0);
+    bool cancel(TimerId id);
+    void stop(); // Drops everything pending and releases the driving timer
+
+    bool isIdle() const {
+        return pendingSlots.isEmpty();
+    }
+
+    // Exponential backoff from baseMs, capped at maxMs, spread by up to 10% either way so retries
+    // of many docks do not line up
+    static int backoffDelay(int baseMs, int attempt, int maxMs);
+
+    double wakeupsPerSecond() const;
+    QJsonObject toJson() const;
+
+private:
+    struct Entry {
+        TimerId id;
+        quint64 deadlineTick;
+        std::function<void()> task;
+        QPointer<QObject> context;
+        bool hasContext;
+    };
+
+    quint64 now() const;
+    std::vector<Entry>& slotAt(int slotIndex);
+    void insert(Entry &&entry);
+    void advance();
+    void rearm();
+
+    std::vector<Entry> innerWheel[TIMER_WHEEL_SLOTS];
+    std::vector<Entry> outerWheel[TIMER_WHEEL_SLOTS];
+    QHash<TimerId, int> pendingSlots; // Slot each pending entry is in, outer slots come after the inner ones
+    TimerId nextId = 1;
+    quint64 currentTick = 0;
+
+    QTimer *timer = nullptr;
+    QElapsedTimer clock;
+
+    quint64 wakeups = 0;
+    quint64 tasksRun = 0;
+    quint64 rateWindowStartMs = 0;
+    quint64 rateWindowWakeups = 0;
+    double lastWakeupRate = 0.0;
+};
\ No newline at end of file
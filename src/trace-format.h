@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Binary trace of window-system events and plugin actions.
+ *
+ * File layout:
+ *   char     magic[4]   "WDTR"
+ *   uint32_t version    TRACE_FORMAT_VERSION, little endian
+ *   uint64_t start      os_gettime_ns() when recording started, little endian
+ *   records...
+ *
+ * Every record starts with a one byte type and a varint time delta in microseconds since the
+ * previous record. All integers after that are LEB128 varints, window handles included.
+ * Strings are interned: the first use emits a TRACE_STRING record (id, byte length, UTF-8
+ * bytes) and every record refers to strings by id afterwards.
+ */
+
+#define TRACE_FORMAT_MAGIC "WDTR"
+#define TRACE_FORMAT_VERSION 1
+
+enum trace_record_type {
+    TRACE_STRING = 1,          /* id, length, bytes */
+    TRACE_ENUMERATION = 2,     /* count, then per window: hwnd, pid, title id, executable id */
+    TRACE_WINDOW_CREATE = 3,   /* hwnd */
+    TRACE_WINDOW_DESTROY = 4,  /* hwnd */
+    TRACE_WINDOW_TITLE = 5,    /* hwnd, title id */
+    TRACE_WINDOW_RESIZE = 6,   /* hwnd, width, height */
+    TRACE_APPLY_BEGIN = 7,     /* entry count */
+    TRACE_APPLY_END = 8,       /* entry count */
+    TRACE_DOCK_CREATE = 9,     /* dock id, hwnd (0), window title id */
+    TRACE_DOCK_REMOVE = 10,    /* dock id, hwnd (0), window title id */
+    TRACE_DOCK_ATTACH = 11,    /* dock id, hwnd, window title id */
+    TRACE_DOCK_DETACH = 12,    /* dock id, hwnd, window title id */
+};
\ No newline at end of file
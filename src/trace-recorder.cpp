@@ -0,0 +1,249 @@
+#include "trace-recorder.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+
+constexpr int TRACE_FLUSH_THRESHOLD = 64 * 1024;
+
+
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder traceRecorder;
+    return traceRecorder;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*--------------------------------------RECORDING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+bool TraceRecorder::start(const QString &filePath) {
+    if (recording) {
+        stop();
+    }
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        blog(LOG_ERROR, "Failed to open trace file for writing: %s", filePath.toStdString().c_str());
+        return false;
+    }
+
+    buffer.clear();
+    stringIds.clear();
+    lastTimestampNs = os_gettime_ns();
+
+    // Header: magic, version and start time, all little endian
+    quint32 version = TRACE_FORMAT_VERSION;
+    buffer.append(TRACE_FORMAT_MAGIC, 4);
+    buffer.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    buffer.append(reinterpret_cast<const char*>(&lastTimestampNs), sizeof(lastTimestampNs));
+
+    // Out-of-context hooks are delivered on this (UI) thread through its message loop
+    createDestroyHook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, nullptr, winEventProc, 0, 0,
+                                        WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    nameChangeHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, winEventProc, 0, 0,
+                                     WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+    recording = true;
+    blog(LOG_INFO, "Recording window dock trace to: %s", filePath.toStdString().c_str());
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!recording) {
+        return;
+    }
+
+    if (createDestroyHook) {
+        UnhookWinEvent(createDestroyHook);
+        createDestroyHook = nullptr;
+    }
+    if (nameChangeHook) {
+        UnhookWinEvent(nameChangeHook);
+        nameChangeHook = nullptr;
+    }
+
+    flush(true);
+    file.close();
+    recording = false;
+
+    blog(LOG_INFO, "Window dock trace saved: %s", file.fileName().toStdString().c_str());
+}
+
+void CALLBACK TraceRecorder::winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                                          DWORD eventThread, DWORD eventTime) {
+    UNUSED_PARAMETER(hook);
+    UNUSED_PARAMETER(eventThread);
+    UNUSED_PARAMETER(eventTime);
+
+    // Only whole top-level windows matter, not their accessible children
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hwnd) {
+        return;
+    }
+
+    TraceRecorder &traceRecorder = instance();
+    if (!traceRecorder.recording) {
+        return;
+    }
+
+    switch (event) {
+    case EVENT_OBJECT_CREATE:
+        if (GetAncestor(hwnd, GA_ROOT) == hwnd) {
+            traceRecorder.recordWindowEvent(TRACE_WINDOW_CREATE, hwnd);
+        }
+        break;
+    case EVENT_OBJECT_DESTROY:
+        traceRecorder.recordWindowEvent(TRACE_WINDOW_DESTROY, hwnd);
+        break;
+    case EVENT_OBJECT_NAMECHANGE:
+        if (GetAncestor(hwnd, GA_ROOT) == hwnd) {
+            wchar_t windowTitle[512];
+            int length = GetWindowTextW(hwnd, windowTitle, 512);
+            traceRecorder.recordTitleChange(hwnd, QString::fromWCharArray(windowTitle, length));
+        }
+        break;
+    }
+}
+
+void TraceRecorder::recordEnumeration(const std::vector<WindowInfo> &windows) {
+    if (!recording) {
+        return;
+    }
+
+    std::vector<std::pair<quint32, quint32>> stringPairs;
+    stringPairs.reserve(windows.size());
+    for (const WindowInfo &window : windows) {
+        stringPairs.emplace_back(internString(window.title), internString(window.executable));
+    }
+
+    beginRecord(TRACE_ENUMERATION);
+    writeVarint(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        writeVarint((quint64)(uintptr_t)windows[i].hwnd);
+        writeVarint(windows[i].processId);
+        writeVarint(stringPairs[i].first);
+        writeVarint(stringPairs[i].second);
+    }
+    flush(false);
+}
+
+void TraceRecorder::recordWindowEvent(trace_record_type type, HWND hwnd) {
+    if (!recording) {
+        return;
+    }
+
+    beginRecord(type);
+    writeVarint((quint64)(uintptr_t)hwnd);
+    flush(false);
+}
+
+void TraceRecorder::recordTitleChange(HWND hwnd, const QString &title) {
+    if (!recording) {
+        return;
+    }
+
+    quint32 titleId = internString(title);
+    beginRecord(TRACE_WINDOW_TITLE);
+    writeVarint((quint64)(uintptr_t)hwnd);
+    writeVarint(titleId);
+    flush(false);
+}
+
+void TraceRecorder::recordResize(HWND hwnd, int width, int height) {
+    if (!recording) {
+        return;
+    }
+
+    beginRecord(TRACE_WINDOW_RESIZE);
+    writeVarint((quint64)(uintptr_t)hwnd);
+    writeVarint((quint64)qMax(width, 0));
+    writeVarint((quint64)qMax(height, 0));
+    flush(false);
+}
+
+void TraceRecorder::recordApply(trace_record_type type, int entryCount) {
+    if (!recording) {
+        return;
+    }
+
+    beginRecord(type);
+    writeVarint((quint64)qMax(entryCount, 0));
+    flush(false);
+}
+
+void TraceRecorder::recordDockAction(trace_record_type type, const QString &dockId, HWND hwnd, const QString &windowTitle) {
+    if (!recording) {
+        return;
+    }
+
+    quint32 dockIdId = internString(dockId);
+    quint32 titleId = internString(windowTitle);
+
+    beginRecord(type);
+    writeVarint(dockIdId);
+    writeVarint((quint64)(uintptr_t)hwnd);
+    writeVarint(titleId);
+    flush(false);
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------ENCODING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+quint32 TraceRecorder::internString(const QString &value) {
+    auto stringIter = stringIds.constFind(value);
+    if (stringIter != stringIds.constEnd()) {
+        return stringIter.value();
+    }
+
+    quint32 id = (quint32)stringIds.size();
+    stringIds.insert(value, id);
+
+    QByteArray utf8 = value.toUtf8();
+    beginRecord(TRACE_STRING);
+    writeVarint(id);
+    writeVarint((quint64)utf8.size());
+    buffer.append(utf8);
+
+    return id;
+}
+
+void TraceRecorder::beginRecord(trace_record_type type) {
+    quint64 now = os_gettime_ns();
+    quint64 deltaUs = (now - lastTimestampNs) / 1000;
+    lastTimestampNs += deltaUs * 1000;  // Carry the sub-microsecond remainder into the next delta
+
+    buffer.append((char)type);
+    writeVarint(deltaUs);
+}
+
+void TraceRecorder::writeVarint(quint64 value) {
+    do {
+        quint8 byte = value & 0x7f;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        buffer.append((char)byte);
+    } while (value);
+}
+
+void TraceRecorder::flush(bool force) {
+    if (buffer.isEmpty() || (!force && buffer.size() < TRACE_FLUSH_THRESHOLD)) {
+        return;
+    }
+
+    file.write(buffer);
+    buffer.clear();
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+#include "trace-format.h"
+#include "window-registry.hpp"
+
+
+// Records window-system events and the plugin's own dock actions into a compact binary trace
+// (see trace-format.h), so field timing issues can be captured and replayed later.
+class TraceRecorder {
+public:
+    static TraceRecorder& instance();
+
+    bool start(const QString &filePath);
+    void stop();
+
+    bool isRecording() const {
+        return recording;
+    }
+
+    void recordEnumeration(const std::vector<WindowInfo> &windows);
+    void recordWindowEvent(trace_record_type type, HWND hwnd);
+    void recordTitleChange(HWND hwnd, const QString &title);
+    void recordResize(HWND hwnd, int width, int height);
+    void recordApply(trace_record_type type, int entryCount);
+    void recordDockAction(trace_record_type type, const QString &dockId, HWND hwnd, const QString &windowTitle = QString());
+
+private:
+    TraceRecorder() = default;
+
+    static void CALLBACK winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                                      DWORD eventThread, DWORD eventTime);
+
+    quint32 internString(const QString &value);
+    void beginRecord(trace_record_type type);
+    void writeVarint(quint64 value);
+    void flush(bool force);
+
+    QFile file;
+    QByteArray buffer;
+    QHash<QString, quint32> stringIds;
+    quint64 lastTimestampNs = 0;
+    bool recording = false;
+
+    HWINEVENTHOOK createDestroyHook = nullptr;
+    HWINEVENTHOOK nameChangeHook = nullptr;
+};
\ No newline at end of file
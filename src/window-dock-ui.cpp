@@ -1,5 +1,11 @@
 #include "window-dock-ui.hpp"
 
+#include <util/platform.h>
+
+#ifdef ENABLE_STRESS_HARNESS
+#include "stress-harness.hpp"
+#endif
+
 
 
 
@@ -13,7 +19,14 @@
 
 WindowDockUI::WindowDockUI(QWidget *parent)
     : QWidget(parent) {
-    // Constructor logic, if any
+    connect(&appIconCache, &AppIconCache::iconReady, this, &WindowDockUI::onAppIconReady);
+    connect(&WindowWatcher::instance(), &WindowWatcher::windowDestroyed, this, &WindowDockUI::onWindowDestroyed);
+    connect(&WindowWatcher::instance(), &WindowWatcher::windowAppeared, this, &WindowDockUI::onWindowAppeared);
+
+    // A timer of its own, the timer wheel's 100 ms ticks are too coarse to re-capture within 100 ms
+    rematchTimer.setSingleShot(true);
+    rematchTimer.setInterval(LOST_WINDOW_REMATCH_DELAY_MS);
+    connect(&rematchTimer, &QTimer::timeout, this, &WindowDockUI::rematchLostWindows);
 }
 
 
@@ -26,54 +39,6 @@ WindowDockUI::WindowDockUI(QWidget *parent)
 
 
 
-std::vector<std::pair<QString, HWND>> WindowDockUI::getDesktopWindows() {
-    std::vector<std::pair<QString, HWND>> windows;
-
-    auto enumWindowsCallback = [](HWND hwnd, LPARAM lParam) -> BOOL {
-        auto* windows = reinterpret_cast<std::vector<std::pair<QString, HWND>>*>(lParam);
-
-        if (!hwnd || !IsWindow(hwnd)) {
-            // blog(LOG_WARNING, "EnumWindowsProc: Invalid HWND encountered.");
-            return TRUE;  // Continue enumeration even if an invalid window handle is found
-        }
-
-        char windowTitle[256];
-        int length = GetWindowTextA(hwnd, windowTitle, sizeof(windowTitle));
-
-        if (length > 0 && IsWindowVisible(hwnd)) {
-            // Get the process ID associated with the window
-            DWORD processId;
-            GetWindowThreadProcessId(hwnd, &processId);
-
-            // Open the process to retrieve the executable name
-            HANDLE processHandle = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-            if (processHandle) {
-                char processName[MAX_PATH];
-                if (GetModuleBaseNameA(processHandle, NULL, processName, sizeof(processName))) {
-                    // Format the string as "[APPLICATION_EXECUTABLE]: WINDOW_NAME"
-                    QString title = QString("[%1]: %2").arg(processName).arg(QString::fromUtf8(windowTitle));
-                    windows->emplace_back(title, hwnd);
-                } else {
-                    // blog(LOG_WARNING, "EnumWindowsProc: Failed to get process name for PID: %lu", processId);
-                }
-                CloseHandle(processHandle);
-            } else {
-                // blog(LOG_WARNING, "EnumWindowsProc: Failed to open process for PID: %lu", processId);
-            }
-        } else {
-            // blog(LOG_INFO, "EnumWindowsProc: Skipping window: %p (length: %d, visible: %d)", hwnd, length, IsWindowVisible(hwnd));
-        }
-
-        return TRUE;  // Continue enumeration
-    };
-
-    if (!EnumWindows(enumWindowsCallback, reinterpret_cast<LPARAM>(&windows))) {
-        blog(LOG_ERROR, "EnumWindows failed with error: %lu", GetLastError());
-    }
-
-    return windows;
-}
-
 BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
     QComboBox* comboBox = reinterpret_cast<QComboBox*>(lParam);
     if (!comboBox) {
@@ -94,24 +59,74 @@ BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
     return TRUE; // Continue enumeration
 }
 
-void WindowDockUI::populateDesktopWindowsComboBox(QComboBox* comboBox) {
-    // blog(LOG_INFO, "populateDesktopWindowsComboBox called");
+// One picker row: an editable combo box on the shared window list, typing narrows it down in a popup
+QComboBox* WindowDockUI::createWindowPicker() {
+    QComboBox *comboBox = new QComboBox();
 
-    comboBox->clear();
-
-    // Add the "Select a window..." placeholder
-    comboBox->addItem(obs_module_text("DockManagement.DesktopWindowComboBoxPlaceholder"));
+    // The first row of a dialog enumerates, later rows reuse the list unless it has gone stale
+    if (!windowListModel) {
+        int iconPixelSize = qRound(comboBox->iconSize().width() * comboBox->devicePixelRatioF());
+        windowListModel = new WindowListModel(appIconCache, iconPixelSize, customWindowDocksUI);
+    }
+    if (windowListModel->isStale()) {
+        windowListModel->update(windowRegistry.refresh());
+    }
 
-    // Get the list of windows
-    auto windows = getDesktopWindows();
+    comboBox->setModel(windowListModel);
+    comboBox->setEditable(true);
+    comboBox->setInsertPolicy(QComboBox::NoInsert);
+    if (QListView *listView = qobject_cast<QListView*>(comboBox->view())) {
+        listView->setUniformItemSizes(true); // Lets the view skip measuring rows it never paints
+    }
 
-    // Populate the combo box in the main UI thread
-    for (const auto& window : windows) {
-        comboBox->addItem(window.first, QVariant::fromValue(window.second));
+    WindowFilterModel *filterModel = new WindowFilterModel(windowListModel, comboBox);
+    QCompleter *completer = new QCompleter(filterModel, comboBox);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(15);
+    if (QListView *popupView = qobject_cast<QListView*>(completer->popup())) {
+        popupView->setUniformItemSizes(true);
     }
+    comboBox->setCompleter(completer);
+
+    QObject::connect(comboBox->lineEdit(), &QLineEdit::textEdited, [filterModel, completer](const QString &text) {
+        filterModel->setFilterText(text);
+        completer->complete();
+    });
+
+    QObject::connect(completer, QOverload<const QModelIndex&>::of(&QCompleter::activated), [comboBox, filterModel](const QModelIndex &index) {
+        comboBox->setCurrentIndex(filterModel->sourceRow(index.row()));
+    });
+
+    // Text typed without picking a window goes back to the current selection
+    QObject::connect(comboBox->lineEdit(), &QLineEdit::editingFinished, [comboBox]() {
+        comboBox->lineEdit()->setText(comboBox->itemText(comboBox->currentIndex()));
+    });
+
+    // Rows of closed windows go away when the list is updated for a later row. The picker is kept quiet
+    // meanwhile and picks its window again by HWND, so the user's choice never moves to a neighbour.
+    QObject::connect(windowListModel, &WindowListModel::aboutToUpdate, comboBox, [comboBox]() {
+        comboBox->setProperty("selectedHwnd", comboBox->currentData(Qt::UserRole));
+        comboBox->blockSignals(true);
+    });
+    QObject::connect(windowListModel, &WindowListModel::updated, comboBox, [this, comboBox]() {
+        HWND selectedHwnd = comboBox->property("selectedHwnd").value<HWND>();
+        comboBox->setCurrentIndex(selectedHwnd ? windowListModel->rowOf(selectedHwnd) : 0);
+        comboBox->blockSignals(false);
+    });
 
-    // Ensure the "Select a window..." option is selected by default
     comboBox->setCurrentIndex(0);
+    return comboBox;
+}
+
+void WindowDockUI::onAppIconReady(const QString &executablePath) {
+    if (!customWindowDocksUI) {
+        return;
+    }
+
+    // Every picker row shows the shared list, so repainting its rows fills in the icon everywhere
+    if (windowListModel) {
+        windowListModel->iconReady(executablePath);
+    }
 }
 
 QString WindowDockUI::extractWindowTitle(const QString &fullName) {
@@ -129,9 +144,51 @@ QString WindowDockUI::extractWindowTitle(const QString &fullName) {
     return fullName;
 }
 
+QString WindowDockUI::getConfigDirPath() const {
+    return QDir::homePath() + "/AppData/Roaming/obs-studio/plugin_config/window-dock";
+}
+
+QString WindowDockUI::getConfigFilePath() const {
+    return getConfigDirPath() + "/" + configFileName;
+}
+
+void WindowDockUI::loadSettings() {
+    QFile settingsFile(getConfigDirPath() + "/" + SETTINGS_FILE);
+
+    // Write the defaults out once, so there is a file to edit
+    if (!settingsFile.exists()) {
+        QJsonObject settingsObject;
+        settingsObject["windowFilter"] = WindowFilterSettings().toJson();
+        settingsObject["publishMetrics"] = false;
+        settingsObject["dockSets"] = "global";
+
+        QDir().mkpath(getConfigDirPath());
+        if (settingsFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            settingsFile.write(QJsonDocument(settingsObject).toJson());
+            settingsFile.close();
+        }
+        return;
+    }
+
+    if (!settingsFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        blog(LOG_ERROR, "Failed to open settings file: %s", settingsFile.fileName().toStdString().c_str());
+        return;
+    }
+
+    QJsonObject settingsObject = QJsonDocument::fromJson(settingsFile.readAll()).object();
+    settingsFile.close();
+
+    windowRegistry.setFilterSettings(WindowFilterSettings::fromJson(settingsObject["windowFilter"].toObject()));
+    metricsEnabled = settingsObject["publishMetrics"].toBool(false);
+
+    QString dockSets = settingsObject["dockSets"].toString();
+    dockSetMode = dockSets == "sceneCollection" ? DockSetMode::SceneCollection :
+                  dockSets == "profile" ? DockSetMode::Profile : DockSetMode::Global;
+}
+
 QJsonArray WindowDockUI::loadConfigFile() {
-    QString configDir = QDir::homePath() + "/AppData/Roaming/obs-studio/plugin_config/window-dock";
-    QString configFilePath = configDir + "/" + CONFIG_FILE;
+    QString configDir = getConfigDirPath();
+    QString configFilePath = getConfigFilePath();
 
     // Check if directory exists, if not, create it
     QDir dir(configDir);
@@ -228,8 +285,8 @@ void WindowDockUI::addDetachButtonsToTable(QTableWidget *tableWidget) {
 
             if (index >= 0 && index < dockEntries.size()) {
                 const DockEntry &dockEntry = dockEntries.at(index);
-                std::string dockId = dockEntry.oldDockId.toStdString();
-                // blog(LOG_INFO, "Set to detach from: %s (Dock Id: %s)", dockEntry.oldDockName.toStdString().c_str(), dockId.c_str());
+                std::string dockId = dockEntry.original.dockId.toStdString();
+                // blog(LOG_INFO, "Set to detach from: %s (Dock Id: %s)", dockEntry.original.dockName.toStdString().c_str(), dockId.c_str());
                 detachEmbeddedWindow(QString::fromStdString(dockId));
             }
         });
@@ -259,7 +316,10 @@ void WindowDockUI::addTrashButtonsToTable(QTableWidget *tableWidget) {
             int index = safeTableWidget->cellWidget(row, 3)->property("dockEntryIndex").toInt();
 
             if (index >= 0 && index < dockEntries.size()) {
-                // Remove the DockEntry from the list
+                // Remove the DockEntry from the list. The ID of a configured dock is released once Apply removes the dock.
+                if (dockEntries.at(index).isNew()) {
+                    dockIds.release(dockEntries.at(index).current.dockId);
+                }
                 dockEntries.removeAt(index);
                 // blog(LOG_INFO, "Removed dock entry at index %d", index);
 
@@ -282,9 +342,7 @@ void WindowDockUI::addNewRow(QTableWidget *tableWidget) {
     tableWidget->insertRow(newRow);
 
     QLineEdit *dockNameField = new QLineEdit();
-    QComboBox *desktopWindowDropdown = new QComboBox();
-
-    populateDesktopWindowsComboBox(desktopWindowDropdown);
+    QComboBox *desktopWindowDropdown = createWindowPicker();
 
     tableWidget->setCellWidget(newRow, 0, dockNameField);
     tableWidget->setCellWidget(newRow, 1, desktopWindowDropdown);
@@ -296,19 +354,20 @@ void WindowDockUI::addNewRow(QTableWidget *tableWidget) {
 
     auto saveDockEntryAndAddRow = [this, tableWidget, dockNameField, desktopWindowDropdown, newRow, previousDockName]() mutable {
         QString dockName = dockNameField->text().trimmed();
-        QString desktopWindow = extractWindowTitle(desktopWindowDropdown->currentText());
-        QString desktopWindowWithProgramName = desktopWindowDropdown->currentText();
-        QString dockId = QString::fromStdString(PLUGIN_PREFIX) + dockName;
+        // The line edit may still hold filter text, the selected item is what counts
+        QString desktopWindowWithProgramName = desktopWindowDropdown->itemText(desktopWindowDropdown->currentIndex());
+        QString desktopWindow = extractWindowTitle(desktopWindowWithProgramName);
+        QString dockId = makeDockId(dockName, dockEntries);
 
         int currentRow = tableWidget->indexAt(dockNameField->pos()).row();
 
         // Check if the dockName is already in use
         for (const DockEntry &entry : dockEntries) {
-            // blog(LOG_INFO, "Dock name '%s' check to see if already taken.", entry.newDockName.toStdString().c_str());
+            // blog(LOG_INFO, "Dock name '%s' check to see if already taken.", entry.current.dockName.toStdString().c_str());
             // blog(LOG_INFO, "Previous Dock Name (Current Table Row) '%s'", previousDockName.toStdString().c_str());
             // blog(LOG_INFO, "Current Dock Name (Current Table Row) '%s'", dockName.toStdString().c_str());
             
-            if (entry.newDockName == dockName) {
+            if (entry.current.dockName == dockName) {
                 // Dock name is already taken, reset to previous value
                 dockNameField->setText(previousDockName);  // Reset to the previous valid name
                 // blog(LOG_INFO, "Dock name '%s' is already taken, resetting to '%s'", dockName.toStdString().c_str(), previousDockName.toStdString().c_str());
@@ -323,10 +382,9 @@ void WindowDockUI::addNewRow(QTableWidget *tableWidget) {
         if (currentRow == tableWidget->rowCount() - 1 && !dockName.isEmpty() && desktopWindowDropdown->currentIndex() > 0) {
             // Append the new entry to dockEntries
             DockEntry newEntry;
-            newEntry.newDockName = dockName;
-            newEntry.newDesktopWindow = desktopWindow;
-            newEntry.newDesktopWindowWithProgramName = desktopWindowWithProgramName;
-            newEntry.newDockId = dockId;
+            newEntry.setDockName(dockName);
+            newEntry.setTarget(desktopWindow, desktopWindowWithProgramName);
+            newEntry.setDockId(dockIds.intern(dockId));
 
             dockEntries.append(newEntry);
 
@@ -382,6 +440,9 @@ void WindowDockUI::openCustomWindowDocksUI(QWidget *parent) {
         addTrashButtonsToTable(tableWidget);
 
         QHBoxLayout *buttonLayout = new QHBoxLayout();
+
+        QPushButton *frameImpactButton = new QPushButton(obs_module_text("DockManagement.FrameImpact"), customWindowDocksUI);
+        buttonLayout->addWidget(frameImpactButton);
         buttonLayout->addStretch();
 
         QPushButton *applyButton = new QPushButton(obs_module_text("DockManagement.Apply"), customWindowDocksUI);
@@ -396,15 +457,15 @@ void WindowDockUI::openCustomWindowDocksUI(QWidget *parent) {
 
         QObject::connect(applyButton, &QPushButton::clicked, [this, tableWidget]() {
             applyChanges();
-            loadDockEntries(tableWidget);
-            addNewRow(tableWidget);
+            refreshDockTable(tableWidget);
 
             // Bring the dialog back into focus after applying changes
             customWindowDocksUI->raise();  // Bring the dialog to the top
             customWindowDocksUI->activateWindow();  // Set focus back to the dialog
+        });
 
-            addDetachButtonsToTable(tableWidget);
-            addTrashButtonsToTable(tableWidget);
+        QObject::connect(frameImpactButton, &QPushButton::clicked, [this]() {
+            openFrameImpactReport(customWindowDocksUI);
         });
 
         QObject::connect(closeButton, &QPushButton::clicked, [this, tableWidget]() {
@@ -418,64 +479,164 @@ void WindowDockUI::openCustomWindowDocksUI(QWidget *parent) {
         // Reset the pointer when the window is closed
         QObject::connect(customWindowDocksUI, &QDialog::destroyed, [this]() {
             customWindowDocksUI = nullptr;
+            blog(LOG_INFO, "Window picker icon cache: %d icons, %lld KB", appIconCache.count(), appIconCache.memoryUsage() / 1024);
         });
     }
 }
 
-void WindowDockUI::loadDockEntries(QTableWidget *tableWidget) {
-    // blog(LOG_INFO, "loadDockEntries called");
+// Per-dock render and UI frame time impact, measured while the checkbox is ticked
+void WindowDockUI::openFrameImpactReport(QWidget *parent) {
+    QDialog *reportDialog = new QDialog(parent);
+    reportDialog->setWindowTitle(obs_module_text("FrameImpact.WindowTitle"));
+    reportDialog->resize(760, 300);
+    reportDialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(reportDialog);
+
+    QCheckBox *measureCheckBox = new QCheckBox(obs_module_text("FrameImpact.Measure"), reportDialog);
+    measureCheckBox->setChecked(FrameImpactMonitor::instance().isRunning());
+    mainLayout->addWidget(measureCheckBox);
+
+    QTableWidget *tableWidget = new QTableWidget(0, 9, reportDialog);
+    tableWidget->setHorizontalHeaderLabels(QStringList()
+        << obs_module_text("DockManagement.DockName")
+        << obs_module_text("FrameImpact.Attaches")
+        << obs_module_text("FrameImpact.Resizes")
+        << obs_module_text("FrameImpact.Enumerations")
+        << obs_module_text("FrameImpact.Applies")
+        << obs_module_text("FrameImpact.FrameTime")
+        << obs_module_text("FrameImpact.Baseline")
+        << obs_module_text("FrameImpact.DroppedFrames")
+        << obs_module_text("FrameImpact.UiLatency"));
+    tableWidget->verticalHeader()->setVisible(false);
+    tableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    fillFrameImpactTable(tableWidget);
+    mainLayout->addWidget(tableWidget);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+
+    QPushButton *refreshButton = new QPushButton(obs_module_text("FrameImpact.Refresh"), reportDialog);
+    buttonLayout->addWidget(refreshButton);
+
+    QPushButton *exportButton = new QPushButton(obs_module_text("FrameImpact.ExportCsv"), reportDialog);
+    buttonLayout->addWidget(exportButton);
+
+    mainLayout->addLayout(buttonLayout);
+
+    QObject::connect(measureCheckBox, &QCheckBox::toggled, [](bool checked) {
+        if (checked) {
+            FrameImpactMonitor::instance().start();
+        } else {
+            FrameImpactMonitor::instance().stop();
+        }
+    });
+
+    QObject::connect(refreshButton, &QPushButton::clicked, [this, tableWidget]() {
+        fillFrameImpactTable(tableWidget);
+    });
+
+    QObject::connect(exportButton, &QPushButton::clicked, [reportDialog]() {
+        QString filePath = QFileDialog::getSaveFileName(reportDialog, obs_module_text("FrameImpact.ExportCsv"), QString(), "CSV (*.csv)");
+        if (!filePath.isEmpty()) {
+            FrameImpactMonitor::instance().exportCsv(filePath);
+        }
+    });
+
+    reportDialog->show();
+}
+
+void WindowDockUI::fillFrameImpactTable(QTableWidget *tableWidget) {
+    QHash<QString, QString> dockNames;
+    for (const DockEntry &entry : readDockEntries()) {
+        dockNames.insert(entry.current.dockId, entry.current.dockName);
+    }
+
+    QList<FrameImpactReport> reports = FrameImpactMonitor::instance().report();
+    tableWidget->setRowCount(reports.size());
+
+    for (int row = 0; row < reports.size(); ++row) {
+        const FrameImpactReport &dockReport = reports.at(row);
+
+        // Enumerations, applies and resizes of windows no dock knows about are plugin-wide work
+        QString dockName = dockReport.dockId.isEmpty() ? obs_module_text("FrameImpact.PluginWide") : dockNames.value(dockReport.dockId, dockReport.dockId);
+
+        QStringList cells;
+        cells << dockName
+              << QString::number(dockReport.events[FRAME_IMPACT_ATTACH])
+              << QString::number(dockReport.events[FRAME_IMPACT_RESIZE])
+              << QString::number(dockReport.events[FRAME_IMPACT_ENUMERATION])
+              << QString::number(dockReport.events[FRAME_IMPACT_APPLY])
+              << QString::number(dockReport.frameTimeMs, 'f', 3)
+              << QString::number(dockReport.baselineFrameTimeMs, 'f', 3)
+              << QString("%1 / %2").arg(dockReport.laggedFrames).arg(dockReport.skippedFrames)
+              << QString::number(dockReport.maxUiLatencyMs, 'f', 1);
+
+        for (int column = 0; column < cells.size(); ++column) {
+            tableWidget->setItem(row, column, new QTableWidgetItem(cells.at(column)));
+        }
+    }
+}
 
-    // Clear the active dockEntries list to start fresh
-    dockEntries.clear();
+QList<DockEntry> WindowDockUI::readDockEntries() {
+    QList<DockEntry> entries;
 
     QJsonArray docksArray = loadConfigFile();
-    if (docksArray.isEmpty()) {
-        // blog(LOG_INFO, "Config file is empty or failed to load. No dock entries to load.");
-        return;
+    for (const QJsonValue &value : docksArray) {
+        DockConfig config = DockConfig::fromJson(value.toObject());
+        config.dockId = dockIds.intern(config.dockId);
+
+        // Both sides of the entry share the strings just read, edits only detach what they change
+        entries.append(DockEntry(config));
     }
 
-    tableWidget->setRowCount(docksArray.size());
-    for (int i = 0; i < docksArray.size(); ++i) {
-        QJsonObject dockObject = docksArray[i].toObject();
+    return entries;
+}
+
+void WindowDockUI::refreshDockTable(QTableWidget *tableWidget) {
+    loadDockEntries(tableWidget);
+    addNewRow(tableWidget);
+
+    addDetachButtonsToTable(tableWidget);
+    addTrashButtonsToTable(tableWidget);
+}
 
-        DockEntry entry;
-        entry.oldDockName = dockObject["dockName"].toString();
-        entry.oldDesktopWindow = dockObject["desktopWindow"].toString();
-        entry.oldDesktopWindowWithProgramName = dockObject["desktopWindowWithProgramName"].toString();
-        entry.oldDockId = dockObject["dockId"].toString();
+void WindowDockUI::loadDockEntries(QTableWidget *tableWidget) {
+    // blog(LOG_INFO, "loadDockEntries called");
 
-        entry.newDockName = entry.oldDockName;
-        entry.newDesktopWindow = entry.oldDesktopWindow;
-        entry.newDesktopWindowWithProgramName = entry.oldDesktopWindowWithProgramName;
-        entry.newDockId = entry.oldDockId;
+    // Replace the active dockEntries list with a fresh copy of the config
+    dockEntries = readDockEntries();
+    if (dockEntries.isEmpty()) {
+        // blog(LOG_INFO, "Config file is empty or failed to load. No dock entries to load.");
+        return;
+    }
 
-        // Add the entry to the active list
-        dockEntries.append(entry);
+    tableWidget->setRowCount(dockEntries.size());
+    for (int i = 0; i < dockEntries.size(); ++i) {
+        const DockEntry &entry = dockEntries.at(i);
 
         // Populate UI with the values from the entry
-        QLineEdit *dockNameField = new QLineEdit(entry.oldDockName);
+        QLineEdit *dockNameField = new QLineEdit(entry.original.dockName);
         QComboBox *desktopWindowDropdown = new QComboBox();
-        desktopWindowDropdown->addItem(entry.oldDesktopWindowWithProgramName);
+        desktopWindowDropdown->addItem(entry.original.desktopWindowWithProgramName);
 
         tableWidget->setCellWidget(i, 0, dockNameField);
         tableWidget->setCellWidget(i, 1, desktopWindowDropdown);
 
-        QString previousDockName = entry.newDockName;
+        QString previousDockName = entry.current.dockName;
 
         // Connect signals to ensure editing is handled correctly
-        auto saveDockEntryAndAddRow = [this, tableWidget, dockNameField, desktopWindowDropdown, i, previousDockName]() mutable {
+        auto saveDockEntryAndAddRow = [this, tableWidget, dockNameField, i, previousDockName]() mutable {
             QString dockName = dockNameField->text().trimmed();
-            QString desktopWindow = extractWindowTitle(desktopWindowDropdown->currentText());
-            QString desktopWindowWithProgramName = desktopWindowDropdown->currentText();
-            QString dockId = QString::fromStdString(PLUGIN_PREFIX) + dockName;
 
             // Check if the dockName is already in use
             for (const DockEntry &entry : dockEntries) {
-                // blog(LOG_INFO, "Dock name '%s' check to see if already taken.", entry.newDockName.toStdString().c_str());
+                // blog(LOG_INFO, "Dock name '%s' check to see if already taken.", entry.current.dockName.toStdString().c_str());
                 // blog(LOG_INFO, "Previous Dock Name (Current Table Row) '%s'", previousDockName.toStdString().c_str());
                 // blog(LOG_INFO, "Current Dock Name (Current Table Row) '%s'", dockName.toStdString().c_str());
                 
-                if (entry.newDockName == dockName) {
+                if (entry.current.dockName == dockName) {
                     // Dock name is already taken, reset to previous value
                     dockNameField->setText(previousDockName);  // Reset to the previous valid name
                     // blog(LOG_INFO, "Dock name '%s' is already taken, resetting to '%s'", dockName.toStdString().c_str(), previousDockName.toStdString().c_str());
@@ -486,17 +647,12 @@ void WindowDockUI::loadDockEntries(QTableWidget *tableWidget) {
             previousDockName = dockName;
 
             // Validate and handle existing rows
-            if (i >= 0 && i < tableWidget->rowCount()) {
-                // Update the entry
-                DockEntry updatedEntry;
-                updatedEntry.newDockName = dockName;
-                updatedEntry.newDesktopWindow = desktopWindow;
-                updatedEntry.newDesktopWindowWithProgramName = desktopWindowWithProgramName;
-                updatedEntry.newDockId = dockId;
-
-                dockEntries[i] = updatedEntry;  // Update the existing entry in the list
+            if (i >= 0 && i < tableWidget->rowCount() && i < dockEntries.size()) {
+                // Update the entry in place, so Apply can tell a rename from a new dock. The dock keeps
+                // its ID, only its title changes.
+                dockEntries[i].setDockName(dockName);
 
-                // blog(LOG_INFO, "Dock entry updated: Dock Name = %s, Desktop Window = %s", dockName.toStdString().c_str(), desktopWindow.toStdString().c_str());
+                // blog(LOG_INFO, "Dock entry updated: Dock Name = %s", dockName.toStdString().c_str());
             }
         };
 
@@ -509,88 +665,239 @@ void WindowDockUI::loadDockEntries(QTableWidget *tableWidget) {
 
 void WindowDockUI::applyChanges() {
     // blog(LOG_INFO, "applyChanges called");
+    applyDockEntries(dockEntries);
+}
+
+void WindowDockUI::applyDockEntries(const QList<DockEntry> &entries) {
+    TraceRecorder::instance().recordApply(TRACE_APPLY_BEGIN, (int)entries.size());
+    FrameImpactMonitor::instance().recordEvent(FRAME_IMPACT_APPLY);
+    NativeCallCounters callsBefore = nativeCalls;
+
+    dockOrdinals.clear();
+    for (int i = 0; i < entries.size(); ++i) {
+        dockOrdinals.insert(entries.at(i).current.dockId, i);
+    }
 
     // Load the existing dock configurations
     QJsonArray docksArray = loadConfigFile();
 
-    QMap<QString, QJsonObject> currentDocksMap;
+    QSet<QString> configuredDockIds;
     for (const QJsonValue &value : docksArray) {
-        QJsonObject dockObject = value.toObject();
-        QString dockId = dockObject["dockId"].toString();
-        currentDocksMap.insert(dockId, dockObject);
-    }
-
-    // Identify docks to remove
-    QStringList docksToRemove;
-    for (const QString &dockId : currentDocksMap.keys()) {
-        bool found = false;
-        for (const DockEntry &entry : dockEntries) {
-            if (dockId == entry.oldDockId) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            docksToRemove.append(dockId);
-        }
+        configuredDockIds.insert(value.toObject().value(DockConfigKeys::DockId).toString());
     }
 
-    // blog(LOG_INFO, "Current docks in config:");
-    // for (const QString &dockId : currentDocksMap.keys()) {
-        // blog(LOG_INFO, "Config Dock ID: %s", dockId.toStdString().c_str());
-    // }
-
     // blog(LOG_INFO, "UI docks:");
     // for (const DockEntry &entry : dockEntries) {
     //     blog(
     //         LOG_INFO, "UI Dock Entry: oldDockId=%s, newDockId=%s,  oldDockName=%s, newDockName=%s, oldDesktopWindow=%s, newDesktopWindow=%s,  oldDesktopWindowWithProgramName=%s, newDesktopWindowWithProgramName=%s", 
-    //         entry.oldDockId.toStdString().c_str(), entry.newDockId.toStdString().c_str(),
-    //         entry.oldDockName.toStdString().c_str(), entry.newDockName.toStdString().c_str(),
-    //         entry.oldDesktopWindow.toStdString().c_str(), entry.newDesktopWindow.toStdString().c_str(),
-    //         entry.oldDesktopWindowWithProgramName.toStdString().c_str(), entry.newDesktopWindowWithProgramName.toStdString().c_str()
+    //         entry.original.dockId.toStdString().c_str(), entry.current.dockId.toStdString().c_str(),
+    //         entry.original.dockName.toStdString().c_str(), entry.current.dockName.toStdString().c_str(),
+    //         entry.original.desktopWindow.toStdString().c_str(), entry.current.desktopWindow.toStdString().c_str(),
+    //         entry.original.desktopWindowWithProgramName.toStdString().c_str(), entry.current.desktopWindowWithProgramName.toStdString().c_str()
     //     );
     // }
 
-    // Remove docks that are no longer present in the UI
-    for (const QString &dockId : docksToRemove) {
-        // blog(LOG_INFO, "Removing dock: %s", dockId.toStdString().c_str());
-        
-        releaseEmbeddedWindowByDockId(dockId.toStdString().c_str());
-        obs_frontend_remove_dock(dockId.toStdString().c_str());
-        activeDocks.remove(dockId);
-        currentDocksMap.remove(dockId);
+    // Fingerprints follow a dock through a rename, but belong to the old window once the dock is retargeted
+    for (const DockEntry &entry : entries) {
+        if (entry.isNew()) {
+            dockFingerprints.remove(entry.current.dockId);
+            continue;
+        }
+
+        WindowFingerprint fingerprint = dockFingerprints.take(entry.original.dockId);
+        if (!entry.isRetargeted() && !fingerprint.isEmpty()) {
+            dockFingerprints.insert(entry.current.dockId, fingerprint);
+        }
     }
 
-    // Handle new or modified docks
-    for (const DockEntry &entry : dockEntries) {
-        if (entry.isNew()) {
-            createOrUpdateDock(entry.newDockId.toStdString().c_str(), entry.newDockName.toStdString().c_str(), entry.newDesktopWindow.toStdString().c_str());
-            // blog(LOG_INFO, "Created new dock: %s", entry.newDockId.toStdString().c_str());
-        } else if (entry.isModified()) {
-            if (currentDocksMap.contains(entry.oldDockId)) {
-                obs_frontend_remove_dock(entry.oldDockId.toStdString().c_str());
-                activeDocks.remove(entry.oldDockId.toStdString().c_str());
-                // blog(LOG_INFO, "Removed old dock: %s", entry.oldDockId.toStdString().c_str());
+    // Carry out the plan
+    QList<DockOperation> operations = planDockOperations(entries, configuredDockIds);
+    int operationCounts[5] = {};
+
+    for (const DockOperation &operation : operations) {
+        const DockEntry *entry = operation.entryIndex >= 0 ? &entries.at(operation.entryIndex) : nullptr;
+
+        switch (operation.type) {
+        case DockOperationType::Remove:
+            // A dock that is only rebuilt keeps its hotkey bindings, which move along when it comes back
+            // under a new ID (its name changed)
+            removeDock(operation.dockId, entry != nullptr);
+            if (entry && entry->current.dockId != operation.dockId && hotkeyBindings.contains(operation.dockId)) {
+                hotkeyBindings[entry->current.dockId] = hotkeyBindings.take(operation.dockId);
+            }
+            break;
+        case DockOperationType::Create:
+            if (entry->isTiled()) {
+                createOrUpdateTiledDock(entry->current.dockId, entry->current.dockName, entry->current.tiles, entry->current.layout);
+            } else {
+                createOrUpdateDock(entry->current.dockId, entry->current.dockName, entry->current.desktopWindow);
             }
-            createOrUpdateDock(entry.newDockId.toStdString().c_str(), entry.newDockName.toStdString().c_str(), entry.newDesktopWindow.toStdString().c_str());
-            // blog(LOG_INFO, "Updated dock: %s", entry.newDockId.toStdString().c_str());
-        } else if (entry.isUnchanged()) {
-            createOrUpdateDock(entry.newDockId.toStdString().c_str(), entry.newDockName.toStdString().c_str(), entry.newDesktopWindow.toStdString().c_str());
-            // blog(LOG_INFO, "Unchanged dock: %s", entry.newDockId.toStdString().c_str());
+            break;
+        case DockOperationType::Rename:
+            renameDock(operation.dockId, entry->current.dockName);
+            break;
+        case DockOperationType::Retarget:
+            retargetDock(operation.dockId, entry->current.desktopWindow);
+            break;
+        case DockOperationType::Unchanged:
+            break;
         }
+
+        operationCounts[(int)operation.type]++;
     }
 
     // Save updated dock entries to the config file
-    saveDockEntries(dockEntries);
+    saveDockEntries(entries);
+    saveHotkeyBindings();
+
+    NativeCallCounters calls = nativeCalls - callsBefore;
+    lastApplyStats = QJsonObject{
+        {"create", operationCounts[(int)DockOperationType::Create]},
+        {"rename", operationCounts[(int)DockOperationType::Rename]},
+        {"retarget", operationCounts[(int)DockOperationType::Retarget]},
+        {"remove", operationCounts[(int)DockOperationType::Remove]},
+        {"unchanged", operationCounts[(int)DockOperationType::Unchanged]},
+        {"nativeCalls", calls.toJson()},
+        {"ownership", windowOwnership.toJson()}
+    };
+
+    blog(LOG_INFO, "Apply: %d created, %d renamed, %d retargeted, %d removed, %d unchanged, %d native calls",
+         operationCounts[(int)DockOperationType::Create], operationCounts[(int)DockOperationType::Rename],
+         operationCounts[(int)DockOperationType::Retarget], operationCounts[(int)DockOperationType::Remove],
+         operationCounts[(int)DockOperationType::Unchanged], calls.total());
+
+    TraceRecorder::instance().recordApply(TRACE_APPLY_END, (int)entries.size());
+}
+
+QList<DockOperation> WindowDockUI::planDockOperations(const QList<DockEntry> &entries, const QSet<QString> &configuredDockIds) const {
+    QList<DockOperation> operations;
+
+    // Docks that are no longer listed go first, so a dock created under a freed ID never collides with them
+    QSet<QString> listedDockIds;
+    for (const DockEntry &entry : entries) {
+        listedDockIds.insert(entry.original.dockId);
+    }
+    for (const QString &dockId : configuredDockIds) {
+        if (!listedDockIds.contains(dockId)) {
+            operations.append({DockOperationType::Remove, dockId, -1});
+        }
+    }
+
+    for (int i = 0; i < entries.size(); ++i) {
+        const DockEntry &entry = entries.at(i);
+
+        bool live = !entry.isNew() && configuredDockIds.contains(entry.original.dockId) &&
+            (activeDocks.contains(entry.original.dockId) || tiledDocks.contains(entry.original.dockId));
+        if (!live) {
+            operations.append({DockOperationType::Create, entry.current.dockId, i});
+            continue;
+        }
+
+        // Changing the dock ID or the tile set still means a new dock
+        if (entry.needsRecreate()) {
+            operations.append({DockOperationType::Remove, entry.original.dockId, i});
+            operations.append({DockOperationType::Create, entry.current.dockId, i});
+            continue;
+        }
+
+        if (entry.isRenamed()) {
+            operations.append({DockOperationType::Rename, entry.current.dockId, i});
+        }
+        if (entry.isRetargeted() && !entry.isTiled()) {
+            operations.append({DockOperationType::Retarget, entry.current.dockId, i});
+        }
+        if (!entry.isRenamed() && !entry.isRetargeted()) {
+            operations.append({DockOperationType::Unchanged, entry.current.dockId, i});
+        }
+    }
+
+    return operations;
+}
+
+QString WindowDockUI::makeDockId(const QString &dockName, const QList<DockEntry> &entries) {
+    // Renamed docks keep their ID, so the ID derived from a name may still belong to another dock
+    QString baseDockId = QString::fromStdString(PLUGIN_PREFIX) + dockName;
+    QString dockId = baseDockId;
+
+    for (int suffix = 2; ; ++suffix) {
+        bool taken = false;
+        for (const DockEntry &entry : entries) {
+            if (entry.original.dockId == dockId || entry.current.dockId == dockId) {
+                taken = true;
+                break;
+            }
+        }
+        if (!taken) {
+            return dockId;
+        }
+        dockId = baseDockId + "_" + QString::number(suffix);
+    }
+}
+
+void WindowDockUI::removeDock(const QString &dockId, bool keepBindings) {
+    // blog(LOG_INFO, "Removing dock: %s", dockId.toStdString().c_str());
+
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_REMOVE, dockId, nullptr);
+    releaseEmbeddedWindowByDockId(dockId);
+    lostDocks.remove(dockId);
+    dockWindowTitles.remove(dockId);
+    windowOwnership.releaseDock(dockId);
+    timerWheel.cancel(windowSearches.take(dockId));
+    unregisterDockHotkeys(dockId);
+    if (!keepBindings) {
+        hotkeyBindings.remove(dockId);
+        dockFingerprints.remove(dockId);
+        dockIds.release(dockId);
+    }
+
+    nativeCalls.removeDock++;
+    obs_frontend_remove_dock(dockId.toStdString().c_str());
+    activeDocks.remove(dockId);
+    tiledDocks.remove(dockId);
 }
 
+void WindowDockUI::renameDock(const QString &dockId, const QString &dockName) {
+    // The Docks menu entry follows the title of the dock frame
+    if (QDockWidget *frame = getDockFrame(dockId)) {
+        frame->setWindowTitle(dockName);
+    }
+
+    for (DockHotkey *dockHotkey : dockHotkeys.value(dockId)) {
+        QString description = QString(obs_module_text(dockHotkey->focus ? "Hotkeys.FocusDock" : "Hotkeys.ToggleDock")).arg(dockName);
+        obs_hotkey_set_description(dockHotkey->id, description.toUtf8().constData());
+    }
+
+    // blog(LOG_INFO, "Renamed dock: %s", dockId.toStdString().c_str());
+}
+
+void WindowDockUI::retargetDock(const QString &dockId, const QString &windowTitle) {
+    EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+    if (!dockWidget) {
+        return;
+    }
+    dockWindowTitles.insert(dockId, windowTitle);
+    dockFingerprints.remove(dockId); // The fingerprint is of the previous window
+
+    // A dock that was never shown has nothing to hand back, it just looks for the new window once shown
+    if (!dockWidget->isMaterialized()) {
+        deferDockContent(dockWidget, dockId, windowTitle, nullptr, false);
+        return;
+    }
+
+    // Hand the previous window back to the desktop before taking the new one
+    releaseEmbeddedWindow(dockWidget);
+
+    updateDockContent(dockWidget, dockId, windowTitle);
+
+    // blog(LOG_INFO, "Retargeted dock: %s", dockId.toStdString().c_str());
+}
 
 // Save dock entries to configuration
 void WindowDockUI::saveDockEntries(const QList<DockEntry> &dockEntries) {
     // blog(LOG_INFO, "saveDockEntries called");
 
-    QString configDir = QDir::homePath() + "/AppData/Roaming/obs-studio/plugin_config/window-dock";
-    QString filePath = configDir + "/" + CONFIG_FILE;
+    QString configDir = getConfigDirPath();
+    QString filePath = getConfigFilePath();
 
     QDir dir(configDir);
     if (!dir.exists()) {
@@ -604,15 +911,18 @@ void WindowDockUI::saveDockEntries(const QList<DockEntry> &dockEntries) {
 
     // Iterate over dockEntries instead of tableWidget
     for (const DockEntry &entry : dockEntries) {
-        if (!entry.newDockName.isEmpty() && entry.newDesktopWindow != obs_module_text("DockManagement.DesktopWindowComboBoxPlaceholder")) {
-            QJsonObject dockObject;
-            dockObject["dockId"] = entry.newDockId;
-            dockObject["dockName"] = entry.newDockName;
-            dockObject["desktopWindow"] = entry.newDesktopWindow;
-            dockObject["desktopWindowWithProgramName"] = entry.newDesktopWindowWithProgramName;
-            docksArray.append(dockObject);
+        if (!entry.current.dockName.isEmpty() && entry.current.desktopWindow != obs_module_text("DockManagement.DesktopWindowComboBoxPlaceholder")) {
+            DockConfig config = entry.current;
+            if (!entry.isTiled()) {
+                config.layout.clear();
+            }
+
+            // The fingerprint map is authoritative, whatever was loaded with the entry may be stale
+            auto fingerprintIter = dockFingerprints.constFind(config.dockId);
+            config.fingerprint = fingerprintIter != dockFingerprints.constEnd() ? fingerprintIter.value().toJson() : QJsonObject();
+            docksArray.append(config.toJson());
 
-            // blog(LOG_INFO, "Saved dock entry: %s (Window: %s)", entry.newDockName.toStdString().c_str(), entry.newDesktopWindow.toStdString().c_str());
+            // blog(LOG_INFO, "Saved dock entry: %s (Window: %s)", entry.current.dockName.toStdString().c_str(), entry.current.desktopWindow.toStdString().c_str());
         }
     }
 
@@ -638,88 +948,46 @@ void WindowDockUI::saveDockEntries(const QList<DockEntry> &dockEntries) {
 
 
 
-QJsonObject WindowDockUI::getDockConfigById(const QString &dockId) {
-    // blog(LOG_INFO, "getDockConfigById called");
-    
-    QJsonArray docksArray = loadConfigFile(); // Load config as QJsonArray
-
-    for (const QJsonValue &value : docksArray) {
-        if (value.isObject()) {
-            QJsonObject dockObj = value.toObject();
-            
-            // Check if the current object has the correct dockId
-            if (dockObj.value("dockId").toString() == dockId) {
-                return dockObj; // Return the matching dock config
-            }
-        }
-    }
-
-    return QJsonObject(); // Return an empty object if no match is found
-}
-
 void WindowDockUI::attemptWindowCapture(const QString &dockId, const QString &windowTitle) {
     // blog(LOG_INFO, "attemptWindowCapture called");
-    
-    QJsonObject dockConfig = getDockConfigById(dockId); // Get the dock config by dockId
 
-    if (dockConfig.isEmpty()) {
-        // blog(LOG_INFO, "Dock ID not found in config file: %s", dockId.toStdString().c_str());
+    // Only a dock that exists can capture, and all it needs is in memory, so the config file is not read
+    EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+    if (!dockWidget) {
+        // blog(LOG_INFO, "Dock ID not found: %s", dockId.toStdString().c_str());
         return;
     }
 
-    QString dockName = dockConfig.value("dockName").toString();
-    QString desktopWindow = dockConfig.value("desktopWindow").toString();
-
     // Attempt to find and dock the window
-    HWND hwnd = FindWindow(NULL, windowTitle.toStdWString().c_str());
-    if (hwnd) {
-        createOrUpdateDock(dockId, dockName, windowTitle);
-    } else {
-        // blog(LOG_INFO, "Failed to find window: %s", windowTitle.toStdString().c_str());
-    }
+    updateDockContent(dockWidget, dockId, windowTitle);
 }
 
 // Function to detach/remove the embedded window
 void WindowDockUI::detachEmbeddedWindow(const QString &dockId) {
     // blog(LOG_INFO, "detachEmbeddedWindow called");
 
+    // Tiled docks have no placeholder, their tiles are simply handed back to the desktop
+    if (tiledDocks.contains(dockId)) {
+        releaseTiledWindows(tiledDocks.value(dockId));
+        return;
+    }
+
     auto dockIter = activeDocks.find(dockId);
     if (dockIter != activeDocks.end()) {
         auto dockWidget = dockIter.value();
         
         HWND hwnd = dockWidget->getEmbeddedHwnd();
-        if (hwnd) {
-            // Reparent the window back to the desktop (or its original parent)
-            SetParent(hwnd, nullptr);
-
-            // Restore the window's previous style and apply changes
-            SetWindowLongPtr(hwnd, GWL_STYLE, WS_OVERLAPPEDWINDOW | WS_VISIBLE);
-
-            // Restore the window's original position and size
-            RECT originalRect;
-            GetWindowRect(hwnd, &originalRect);
-            SetWindowPos(hwnd, nullptr, originalRect.left, originalRect.top,
-                         originalRect.right - originalRect.left,
-                         originalRect.bottom - originalRect.top,
-                         SWP_NOZORDER | SWP_FRAMECHANGED);
-
-            // Ensure the window is visible
-            ShowWindow(hwnd, SW_SHOW);
+        if (hwnd && !dockWidget->isPoppedOut()) {
+            QElapsedTimer popOutTimer;
+            popOutTimer.start();
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, dockId, hwnd);
 
-            // Clear the embedded HWND in the dock widget
-            dockWidget->setEmbeddedHwnd(nullptr);
-
-            // Clear the existing layout and set blank content
-            clearLayout(dockWidget->layout());
-
-            QString windowTitle = getDockConfigById(dockId)["desktopWindow"].toString();
-            QWidget *blankWidget = createBlankDockContent(dockId, windowTitle);
-
-            if (!dockWidget->layout()) {
-                dockWidget->setLayout(new QVBoxLayout());  // or any other layout type
-            }
-            dockWidget->layout()->addWidget(blankWidget);
+            // Hand the window back to the desktop exactly as it was before it was embedded, but keep it
+            // bound to the dock so the capture button re-embeds it without searching for it again
+            restoreDesktopWindow(hwnd, dockWidget->getOriginalState());
+            dockWidget->setPoppedOut(true);
 
+            blog(LOG_DEBUG, "Popped out dock %s in %.3f ms", dockId.toStdString().c_str(), popOutTimer.nsecsElapsed() / 1000000.0);
             // blog(LOG_INFO, "Detached window from dock with ID: %s", dockId.toStdString().c_str());
         } else {
             // blog(LOG_INFO, "No embedded window found for dock ID: %s", dockId.toStdString().c_str());
@@ -729,40 +997,161 @@ void WindowDockUI::detachEmbeddedWindow(const QString &dockId) {
 
 void WindowDockUI::releaseEmbeddedWindow(EmbeddedWindowWidget *dockWidget) {
     if (!dockWidget) {
-        // blog(LOG_INFO, "Invalid dockWidget passed to releaseEmbeddedWindow");
+        DOCK_LOG(LOG_WARNING, "Invalid dockWidget passed to releaseEmbeddedWindow");
         return;
     }
 
     // Get the embedded window handle (HWND)
     HWND hwnd = dockWidget->getEmbeddedHwnd();
     if (hwnd) {
-        // Reparent the window back to the desktop (or its original parent)
-        SetParent(hwnd, nullptr);
+        // A popped out window is already back on the desktop
+        if (!dockWidget->isPoppedOut()) {
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, activeDocks.key(dockWidget), hwnd);
+
+            // Hand the window back to the desktop
+            restoreDesktopWindow(hwnd, dockWidget->getOriginalState());
+        }
+        windowOwnership.release(hwnd);
+        WindowWatcher::instance().unwatch(hwnd);
+
+        // Clear the embedded HWND in the dock widget
+        dockWidget->setEmbeddedHwnd(nullptr);
 
-        // Restore the window's previous style and apply changes
-        SetWindowLongPtr(hwnd, GWL_STYLE, WS_OVERLAPPEDWINDOW | WS_VISIBLE);
+        DOCK_LOG(LOG_DEBUG, "Released embedded window 0x%llx", hwnd);
+    } else {
+        DOCK_LOG(LOG_DEBUG, "No embedded window to release");
+    }
+}
 
-        // Restore the window's original position and size
-        RECT originalRect;
-        GetWindowRect(hwnd, &originalRect);
-        SetWindowPos(hwnd, nullptr, originalRect.left, originalRect.top,
-                     originalRect.right - originalRect.left,
-                     originalRect.bottom - originalRect.top,
-                     SWP_NOZORDER | SWP_FRAMECHANGED);
+void WindowDockUI::restoreDesktopWindow(HWND hwnd, const NativeWindowState &state, bool async) {
+    // Asynchronous placement only posts the request to the app's thread instead of waiting for it
+    UINT asyncFlags = async ? SWP_ASYNCWINDOWPOS : 0;
+
+    // Reparent the window back to the desktop (or its original parent)
+    nativeCalls.setParent++;
+    SetParent(hwnd, nullptr);
+
+    // Put back the exact styles and placement the window had before it was embedded, when they are known
+    if (state.valid) {
+        nativeCalls.setWindowLong += 2;
+        SetWindowLongPtr(hwnd, GWL_STYLE, state.style);
+        SetWindowLongPtr(hwnd, GWL_EXSTYLE, state.exStyle);
+
+        nativeCalls.setWindowPos++;
+        SetWindowPos(hwnd, nullptr, state.rect.left, state.rect.top,
+                     state.rect.right - state.rect.left,
+                     state.rect.bottom - state.rect.top,
+                     SWP_NOZORDER | SWP_FRAMECHANGED | SWP_SHOWWINDOW | asyncFlags);
+        return;
+    }
 
-        // Ensure the window is visible
+    // Restore the window's previous style and apply changes
+    nativeCalls.setWindowLong++;
+    SetWindowLongPtr(hwnd, GWL_STYLE, WS_OVERLAPPEDWINDOW | WS_VISIBLE);
+
+    // Restore the window's original position and size
+    RECT originalRect;
+    GetWindowRect(hwnd, &originalRect);
+    nativeCalls.setWindowPos++;
+    SetWindowPos(hwnd, nullptr, originalRect.left, originalRect.top,
+                 originalRect.right - originalRect.left,
+                 originalRect.bottom - originalRect.top,
+                 SWP_NOZORDER | SWP_FRAMECHANGED | asyncFlags);
+
+    // Ensure the window is visible
+    if (async) {
+        ShowWindowAsync(hwnd, SW_SHOW);
+    } else {
         ShowWindow(hwnd, SW_SHOW);
+    }
+}
 
-        // Clear the embedded HWND in the dock widget
+void WindowDockUI::postDesktopWindowRestore(HWND hwnd, const NativeWindowState &state) {
+    // The app does not answer, so nothing may wait for it: placement and visibility are only posted to its
+    // thread, the reparent is left to the release thread
+    UINT flags = SWP_ASYNCWINDOWPOS | SWP_NOZORDER | SWP_NOACTIVATE | SWP_SHOWWINDOW;
+    nativeCalls.setWindowPos++;
+    if (state.valid) {
+        SetWindowPos(hwnd, nullptr, state.rect.left, state.rect.top, state.rect.right - state.rect.left,
+                     state.rect.bottom - state.rect.top, flags);
+    } else {
+        SetWindowPos(hwnd, nullptr, 0, 0, 0, 0, flags | SWP_NOMOVE | SWP_NOSIZE);
+    }
+    ShowWindowAsync(hwnd, SW_SHOWNA);
+}
+
+bool WindowDockUI::reembedWindow(const QString &dockId) {
+    EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+    if (!dockWidget || !dockWidget->isPoppedOut()) {
+        return false;
+    }
+
+    // The app may have closed the window while it was popped out
+    HWND hwnd = dockWidget->getEmbeddedHwnd();
+    if (!IsWindow(hwnd)) {
+        windowOwnership.release(hwnd);
+        WindowWatcher::instance().unwatch(hwnd);
         dockWidget->setEmbeddedHwnd(nullptr);
+        dockWidget->setState(DockState::Lost);
+        return false;
+    }
 
-        // blog(LOG_INFO, "Embedded window released successfully.");
-    } else {
-        // blog(LOG_INFO, "No embedded window to release.");
+    // Another dock may have taken the window while it was popped out. The claim and the watch are that
+    // dock's now, this one only lets go of the handle.
+    if (!claimWindow(hwnd, dockId)) {
+        dockWidget->setEmbeddedHwnd(nullptr);
+        return false;
+    }
+
+    QElapsedTimer reembedTimer;
+    reembedTimer.start();
+
+    // Snapshot the window again, the user may have moved it while it was popped out
+    NativeWindowState originalState = NativeWindowState::capture(hwnd);
+
+    nativeCalls.setWindowLong++;
+    SetWindowLongPtr(hwnd, GWL_STYLE, (originalState.style & ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZE | WS_MAXIMIZE | WS_SYSMENU | WS_POPUP)) | WS_CHILD);
+
+    if (!dockWidget->setEmbeddedHwnd(hwnd, originalState)) {
+        blog(LOG_WARNING, "Could not re-embed the window of dock %s, leaving it on the desktop", dockId.toStdString().c_str());
+        restoreDesktopWindow(hwnd, originalState);
+        windowOwnership.release(hwnd);
+        WindowWatcher::instance().unwatch(hwnd);
+        return false;
+    }
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_ATTACH, dockId, hwnd);
+    FrameImpactMonitor::instance().recordAttach(dockId, hwnd);
+    WindowWatcher::instance().watch(hwnd);
+
+    blog(LOG_DEBUG, "Re-embedded dock %s in %.3f ms", dockId.toStdString().c_str(), reembedTimer.nsecsElapsed() / 1000000.0);
+    return true;
+}
+
+void WindowDockUI::releaseTiledWindows(TiledWindowWidget *tiledWidget) {
+    if (!tiledWidget) {
+        return;
+    }
+
+    QString dockId = tiledDocks.key(tiledWidget);
+    for (const TiledWindowWidget::Tile &tile : tiledWidget->getTiles()) {
+        if (tile.hwnd && IsWindow(tile.hwnd)) {
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, dockId, tile.hwnd, tile.windowTitle);
+            restoreDesktopWindow(tile.hwnd, tile.originalState);
+        }
+        windowOwnership.release(tile.hwnd);
+        WindowWatcher::instance().unwatch(tile.hwnd);
     }
+
+    tiledWidget->clearTiles();
 }
 
 void WindowDockUI::releaseEmbeddedWindowByDockId(const QString &dockId) {
+    auto tiledIter = tiledDocks.find(dockId);
+    if (tiledIter != tiledDocks.end()) {
+        releaseTiledWindows(tiledIter.value());
+        return;
+    }
+
     // Find the dock widget by dockId
     auto dockIter = activeDocks.find(dockId);
     if (dockIter != activeDocks.end()) {
@@ -782,6 +1171,12 @@ void WindowDockUI::releaseEmbeddedWindowByDockId(const QString &dockId) {
 void WindowDockUI::freeEmbeddedWindowsOnClose() {
     // blog(LOG_INFO, "freeEmbeddedWindowsOnClose called");
 
+    // Nothing scheduled may run once the docks are gone
+    timerWheel.stop();
+    rematchTimer.stop();
+    WindowWatcher::instance().stop();
+    metricsPublisher.close();
+
     // Iterate over all active docks
     for (auto dockIter = activeDocks.begin(); dockIter != activeDocks.end(); ++dockIter) {
         auto dockWidget = dockIter.value();
@@ -792,23 +1187,135 @@ void WindowDockUI::freeEmbeddedWindowsOnClose() {
         // blog(LOG_INFO, "Freed embedded window for dock: %s", dockIter.key().toStdString().c_str());
     }
 
+    for (TiledWindowWidget *tiledWidget : tiledDocks) {
+        releaseTiledWindows(tiledWidget);
+    }
+
     // blog(LOG_INFO, "All embedded windows have been freed.");
 }
 
-void WindowDockUI::clearLayout(QLayout *layout) {
-    if (layout) {
-        QLayoutItem *item;
-        while ((item = layout->takeAt(0)) != nullptr) {
-            if (item->widget()) {
-                delete item->widget();
-            }
-            delete item;
+static bool isWindowResponsive(HWND hwnd, UINT timeoutMs) {
+    if (IsHungAppWindow(hwnd)) {
+        return false;
+    }
+
+    DWORD_PTR result;
+    return SendMessageTimeoutW(hwnd, WM_NULL, 0, 0, SMTO_ABORTIFHUNG | SMTO_BLOCK, timeoutMs, &result) != 0;
+}
+
+void WindowDockUI::releaseWindowsOnExit() {
+    QElapsedTimer releaseTimer;
+    releaseTimer.start();
+
+    struct PendingRelease {
+        QString dockId;
+        HWND hwnd;
+        NativeWindowState state;
+    };
+
+    // Gather every window that is still embedded, in single window and tiled docks alike. The docks
+    // let go of them right away, so the release at unload has nothing left to do.
+    std::vector<PendingRelease> pending;
+    for (auto dockIter = activeDocks.begin(); dockIter != activeDocks.end(); ++dockIter) {
+        EmbeddedWindowWidget *dockWidget = dockIter.value();
+        HWND hwnd = dockWidget->getEmbeddedHwnd();
+        if (hwnd && !dockWidget->isPoppedOut() && IsWindow(hwnd)) {
+            pending.push_back({dockIter.key(), hwnd, dockWidget->getOriginalState()});
+        }
+        dockWidget->setEmbeddedHwnd(nullptr);
+    }
+
+    for (auto tiledIter = tiledDocks.begin(); tiledIter != tiledDocks.end(); ++tiledIter) {
+        for (const TiledWindowWidget::Tile &tile : tiledIter.value()->getTiles()) {
+            if (tile.hwnd && IsWindow(tile.hwnd)) {
+                pending.push_back({tiledIter.key(), tile.hwnd, tile.originalState});
+            }
+        }
+        tiledIter.value()->clearTiles();
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    int releasedCount = 0;
+    std::vector<std::pair<HWND, NativeWindowState>> hungWindows;
+
+    // Each app gets a short probe, and all of them together no more than the deadline: once it has passed,
+    // the windows left are treated as hung without asking
+    for (const PendingRelease &release : pending) {
+        qint64 remainingMs = SHUTDOWN_RELEASE_DEADLINE_MS - releaseTimer.elapsed();
+        if (remainingMs > 0 && isWindowResponsive(release.hwnd, (UINT)std::min<qint64>(SHUTDOWN_PROBE_TIMEOUT_MS, remainingMs))) {
+            restoreDesktopWindow(release.hwnd, release.state, true);
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, release.dockId, release.hwnd);
+            releasedCount++;
+            continue;
+        }
+
+        // Only non-blocking calls here, the window must not stay a child of OBS, which would take it down
+        postDesktopWindowRestore(release.hwnd, release.state);
+        hungWindows.push_back({release.hwnd, release.state});
+        hungWindowCount++;
+        blog(LOG_WARNING, "Window of dock %s is not responding, posted an asynchronous restore and queued its reparent",
+             release.dockId.toStdString().c_str());
+    }
+
+    // SetParent waits for the app's thread, so the reparent of hung windows runs on a thread of its own,
+    // which is joined at unload
+    if (!hungWindows.empty()) {
+        releaseThread = std::thread([hungWindows]() {
+            for (const auto &[hwnd, state] : hungWindows) {
+                if (IsWindow(hwnd)) {
+                    restoreDesktopWindow(hwnd, state, true);
+                }
+            }
+        });
+    }
+
+    blog(LOG_INFO, "Released %d docked windows on exit in %.2f ms, %d hung",
+         releasedCount, releaseTimer.nsecsElapsed() / 1000000.0, (int)hungWindows.size());
+
+    // Monitors get to see the hung windows before the segment goes away
+    if (hungWindowCount > 0 && metricsPublisher.isOpen()) {
+        publishMetrics();
+    }
+}
+
+void WindowDockUI::joinReleaseThread() {
+    if (!releaseThread.joinable()) {
+        return;
+    }
+
+    if (WaitForSingleObject(releaseThread.native_handle(), SHUTDOWN_REPARENT_JOIN_MS) == WAIT_OBJECT_0) {
+        releaseThread.join();
+        return;
+    }
+
+    // The app still does not answer: the module is pinned, so the thread never runs code that was unloaded
+    HMODULE module;
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+                       reinterpret_cast<LPCWSTR>(&isWindowResponsive), &module);
+    releaseThread.detach();
+    blog(LOG_WARNING, "Reparent of hung windows still waiting after %d ms, pinned the module", SHUTDOWN_REPARENT_JOIN_MS);
+}
+
+void WindowDockUI::clearLayout(QLayout *layout) {
+    if (layout) {
+        QLayoutItem *item;
+        while ((item = layout->takeAt(0)) != nullptr) {
+            if (item->widget()) {
+                delete item->widget();
+            }
+            delete item;
         }
     }
 }
 
 void WindowDockUI::restoreDocksOnStartup() {
     // blog(LOG_INFO, "restoreDocksOnStartup called");
+    startupClock.start();
+    loadSettings();
+    activateDockSet(dockSetFileName(currentDockSetName()));
 
     QJsonArray docksArray = loadConfigFile();
     if (docksArray.isEmpty()) {
@@ -816,15 +1323,274 @@ void WindowDockUI::restoreDocksOnStartup() {
         return;
     }
 
+    // Only the dock shells are registered here, the windows are matched once the first dock is shown
+    // or OBS has finished loading
+    startupMatching = true;
+    int dockCount = 0;
+
     // Load existing docks from the config
     for (const QJsonValue &value : docksArray) {
-        QJsonObject dockObject = value.toObject();
-        QString dockId = dockObject["dockId"].toString();
-        QString dockName = dockObject["dockName"].toString();
-        QString windowTitle = dockObject["desktopWindow"].toString();
+        DockConfig config = DockConfig::fromJson(value.toObject());
+        QString dockId = dockIds.intern(config.dockId);
+        QString dockName = config.dockName;
+        QString windowTitle = config.desktopWindow;
+        dockOrdinals.insert(dockId, dockOrdinals.size());
+
+        if (config.isTiled()) {
+            createOrUpdateTiledDock(dockId, dockName, config.tiles, config.layout);
+            continue;
+        }
+
+        WindowFingerprint fingerprint = WindowFingerprint::fromJson(config.fingerprint);
+        if (!fingerprint.isEmpty()) {
+            dockFingerprints.insert(dockId, fingerprint);
+        }
 
+        startupDocks.append({dockId, windowTitle});
         initiateDockCreationOnStartup(dockId, dockName, windowTitle);
+        dockCount++;
+    }
+
+    blog(LOG_INFO, "Registered %d docks in %.2f ms, content is built on first show", dockCount, startupClock.nsecsElapsed() / 1000000.0);
+}
+
+void WindowDockUI::finishStartup() {
+    QElapsedTimer finishTimer;
+    finishTimer.start();
+
+    // A hidden dock with a bound hotkey is materialized now, while the startup enumeration can still be
+    // shared, so the hotkey shows it with its window already embedded instead of starting a search
+    for (auto dockIter = activeDocks.begin(); dockIter != activeDocks.end(); ++dockIter) {
+        if (!dockIter.value()->isMaterialized() && hasHotkeyBinding(dockIter.key())) {
+            dockIter.value()->materialize();
+        }
+    }
+
+    // Docks first shown from now on look for their window on their own
+    startupMatching = false;
+    startupDocks.clear();
+    startupMatches.clear();
+
+    for (TiledWindowWidget *tiledWidget : std::exchange(startupTiledDocks, {})) {
+        if (tiledWidget && captureMissingTiles(tiledWidget) > 0) {
+            startTileSearch(tiledWidget);
+        }
+    }
+
+    FocusRouter::instance().start();
+
+    if (metricsEnabled && metricsPublisher.open()) {
+        publishMetrics();
+        scheduleMetricsPublish();
+    }
+
+    publishProcSnapshot();
+
+    blog(LOG_INFO, "Finished startup %lld ms after load in %.2f ms (%d of %d docks materialized)",
+         startupClock.elapsed(), finishTimer.nsecsElapsed() / 1000000.0, materializedDockCount, (int)activeDocks.size());
+}
+
+void WindowDockUI::matchStartupWindows() {
+    if (startupDocks.isEmpty()) {
+        return;
+    }
+
+    // One enumeration serves every dock shown while OBS is starting, instead of one per dock
+    QElapsedTimer matchTimer;
+    matchTimer.start();
+    const std::vector<WindowInfo> &windows = windowRegistry.refresh();
+    // Windows docked already stay out, and several docks for the same app each get their own instance
+    QSet<HWND> matchedWindows = windowOwnership.ownedByOthers(QString());
+
+    for (const QPair<QString, QString> &startupDock : startupDocks) {
+        EmbeddedWindowWidget *dockWidget = activeDocks.value(startupDock.first, nullptr);
+        if (!dockWidget || dockWidget->getEmbeddedHwnd()) {
+            continue;
+        }
+
+        const WindowInfo *window = matchWindow(windows, startupDock.second, dockFingerprints.value(startupDock.first), matchedWindows);
+        if (window) {
+            matchedWindows.insert(window->hwnd);
+            startupMatches.insert(startupDock.first, window->hwnd);
+        }
+    }
+
+    blog(LOG_INFO, "Matched %d of %d startup docks from one enumeration in %.2f ms",
+         (int)startupMatches.size(), (int)startupDocks.size(), matchTimer.nsecsElapsed() / 1000000.0);
+    startupDocks.clear();
+}
+
+QString WindowDockUI::currentDockSetName() const {
+    char *name = nullptr;
+    switch (dockSetMode) {
+    case DockSetMode::SceneCollection:
+        name = obs_frontend_get_current_scene_collection();
+        break;
+    case DockSetMode::Profile:
+        name = obs_frontend_get_current_profile();
+        break;
+    case DockSetMode::Global:
+        return QString();
+    }
+
+    QString setName = QString::fromUtf8(name);
+    bfree(name);
+    return setName;
+}
+
+QString WindowDockUI::dockSetFileName(const QString &setName) const {
+    if (dockSetMode == DockSetMode::Global || setName.isEmpty()) {
+        return CONFIG_FILE;
+    }
+
+    // Collection and profile names may hold anything, the file name keeps letters, digits, '-' and '_'
+    QString fileName;
+    for (const QChar &c : setName) {
+        fileName.append(c.isLetterOrNumber() || c == '-' || c == '_' ? c : QChar('_'));
+    }
+
+    QString prefix = dockSetMode == DockSetMode::SceneCollection ? "collection-" : "profile-";
+    return QString("%1/%2%3.json").arg(DOCK_SETS_DIR, prefix, fileName);
+}
+
+void WindowDockUI::activateDockSet(const QString &fileName) {
+    configFileName = fileName;
+    if (fileName == CONFIG_FILE) {
+        return;
+    }
+
+    // A set starts out as a copy of the global docks, so turning dock sets on does not lose the current ones
+    QString filePath = getConfigFilePath();
+    if (!QFile::exists(filePath)) {
+        QDir().mkpath(getConfigDirPath() + "/" + DOCK_SETS_DIR);
+        QFile::copy(getConfigDirPath() + "/" + CONFIG_FILE, filePath);
+        blog(LOG_INFO, "Created dock set %s", fileName.toStdString().c_str());
+    }
+}
+
+void WindowDockUI::onFrontendEvent(enum obs_frontend_event event) {
+    if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
+        finishStartup();
+        return;
+    }
+
+    bool setChanged = (event == OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED && dockSetMode == DockSetMode::SceneCollection) ||
+                      (event == OBS_FRONTEND_EVENT_PROFILE_CHANGED && dockSetMode == DockSetMode::Profile);
+    if (setChanged) {
+        switchDockSet();
+    }
+}
+
+void WindowDockUI::switchDockSet() {
+    QString fileName = dockSetFileName(currentDockSetName());
+    if (fileName == configFileName) {
+        return;
+    }
+
+    QElapsedTimer switchTimer;
+    switchTimer.start();
+    FrameImpactMonitor::instance().recordEvent(FRAME_IMPACT_APPLY);
+
+    // The dialog edits the set that is going away
+    if (customWindowDocksUI) {
+        customWindowDocksUI->close();
+    }
+
+    // Fingerprints captured for the outgoing set still belong in its file
+    if (fingerprintSavePending) {
+        saveFingerprints();
+    }
+
+    QHash<QString, DockConfig> outgoing;
+    QSet<QString> configuredDockIds;
+    for (const QJsonValue &value : loadConfigFile()) {
+        DockConfig config = DockConfig::fromJson(value.toObject());
+        outgoing.insert(config.dockId, config);
+        configuredDockIds.insert(config.dockId);
+    }
+
+    activateDockSet(fileName);
+    QJsonArray docksArray = loadConfigFile();
+
+    // A dock in both sets is diffed against itself, so it is kept, renamed or retargeted in place
+    QList<DockEntry> entries;
+    for (const QJsonValue &value : docksArray) {
+        DockConfig config = DockConfig::fromJson(value.toObject());
+        config.dockId = dockIds.intern(config.dockId);
+
+        auto outgoingIter = outgoing.constFind(config.dockId);
+        DockEntry entry = outgoingIter != outgoing.constEnd() ? DockEntry(outgoingIter.value()) : DockEntry();
+        entry.setDockId(config.dockId);
+        entry.setDockName(config.dockName);
+        entry.setTarget(config.desktopWindow, config.desktopWindowWithProgramName);
+        entry.setTiles(config.tiles, config.layout);
+        entry.current.fingerprint = config.fingerprint;
+        entries.append(entry);
+
+        if (entry.isNew() || entry.isRetargeted()) {
+            dockFingerprints.remove(config.dockId);
+            WindowFingerprint fingerprint = WindowFingerprint::fromJson(config.fingerprint);
+            if (!fingerprint.isEmpty()) {
+                dockFingerprints.insert(config.dockId, fingerprint);
+            }
+        }
+    }
+
+    dockOrdinals.clear();
+    for (int i = 0; i < entries.size(); ++i) {
+        dockOrdinals.insert(entries.at(i).current.dockId, i);
+    }
+
+    QList<DockOperation> operations = planDockOperations(entries, configuredDockIds);
+    int operationCounts[5] = {};
+
+    // Lay out and repaint the dock area once for the whole switch, as a batched Apply does
+    QWidget *mainWindow = static_cast<QWidget*>(obs_frontend_get_main_window());
+    if (mainWindow) {
+        mainWindow->setUpdatesEnabled(false);
+    }
+
+    for (const DockOperation &operation : operations) {
+        const DockEntry *entry = operation.entryIndex >= 0 ? &entries.at(operation.entryIndex) : nullptr;
+
+        switch (operation.type) {
+        case DockOperationType::Remove:
+            // The dock may come back with another set, so its hotkeys stay bound
+            removeDock(operation.dockId, true);
+            break;
+        case DockOperationType::Create:
+            if (entry->isTiled()) {
+                createOrUpdateTiledDock(entry->current.dockId, entry->current.dockName, entry->current.tiles, entry->current.layout);
+            } else {
+                // The apps of the new set may only be started after the switch, so the dock keeps searching
+                initiateDockCreationOnStartup(entry->current.dockId, entry->current.dockName, entry->current.desktopWindow);
+            }
+            if (QDockWidget *frame = getDockFrame(entry->current.dockId)) {
+                frame->show();
+            }
+            break;
+        case DockOperationType::Rename:
+            renameDock(operation.dockId, entry->current.dockName);
+            break;
+        case DockOperationType::Retarget:
+            retargetDock(operation.dockId, entry->current.desktopWindow);
+            break;
+        case DockOperationType::Unchanged:
+            break;
+        }
+
+        operationCounts[(int)operation.type]++;
     }
+
+    if (mainWindow) {
+        mainWindow->setUpdatesEnabled(true);
+    }
+
+    blog(LOG_INFO, "Switched to dock set %s in %.2f ms: %d created, %d renamed, %d retargeted, %d removed, %d kept",
+         fileName.toStdString().c_str(), switchTimer.nsecsElapsed() / 1000000.0,
+         operationCounts[(int)DockOperationType::Create], operationCounts[(int)DockOperationType::Rename],
+         operationCounts[(int)DockOperationType::Retarget], operationCounts[(int)DockOperationType::Remove],
+         operationCounts[(int)DockOperationType::Unchanged]);
 }
 
 void WindowDockUI::createOrUpdateDock(const QString &dockId, const QString &dockName, const QString &windowTitle) {
@@ -840,9 +1606,111 @@ void WindowDockUI::createOrUpdateDock(const QString &dockId, const QString &dock
     }
 }
 
-EmbeddedWindowWidget* WindowDockUI::createBlankDockContent(const QString &dockId, const QString &windowTitle) {
-    // blog(LOG_INFO, "createBlankDockContent called");
-    EmbeddedWindowWidget *blankWidget = new EmbeddedWindowWidget();
+void WindowDockUI::createOrUpdateTiledDock(const QString &dockId, const QString &dockName, const QJsonArray &tiles, const QString &layoutMode) {
+    auto existingDock = tiledDocks.find(dockId);
+    if (existingDock != tiledDocks.end()) {
+        captureMissingTiles(existingDock.value());
+        return;
+    }
+
+    // Each tile carries its own match rule
+    QStringList windowTitles;
+    for (const QJsonValue &tile : tiles) {
+        windowTitles.append(tile.toObject().value(DockConfigKeys::DesktopWindow).toString());
+    }
+
+    TiledWindowWidget *tiledWidget = new TiledWindowWidget(windowTitles, layoutMode);
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_CREATE, dockId, nullptr, windowTitles.join(" | "));
+
+    tiledDocks[dockId] = tiledWidget;
+
+    nativeCalls.addDock++;
+    if (!obs_frontend_add_dock_by_id(dockId.toStdString().c_str(), dockName.toStdString().c_str(), tiledWidget)) {
+        // blog(LOG_INFO, "Failed to add tiled dock: %s", dockId.toStdString().c_str());
+        tiledDocks.remove(dockId);
+        delete tiledWidget;
+        return;
+    } else {
+        tiledWidget->show();
+        registerDockHotkeys(dockId, dockName);
+    }
+
+    // Tiles of docks restored on startup are captured once OBS has finished loading
+    if (startupMatching) {
+        startupTiledDocks.append(tiledWidget);
+        return;
+    }
+
+    // Keep looking for tiles whose windows are not open yet, on the same schedule as single window docks
+    if (captureMissingTiles(tiledWidget) > 0) {
+        startTileSearch(tiledWidget);
+    }
+}
+
+void WindowDockUI::startTileSearch(TiledWindowWidget *tiledWidget, int attempt) {
+    if (attempt >= WINDOW_SEARCH_ATTEMPTS) {
+        return;
+    }
+
+    // Dropped by the wheel if the dock is removed in the meantime
+    timerWheel.schedule(TimerWheel::backoffDelay(WINDOW_SEARCH_INTERVAL_MS, attempt, WINDOW_SEARCH_MAX_INTERVAL_MS), [this, tiledWidget, attempt]() {
+        if (captureMissingTiles(tiledWidget) > 0) {
+            startTileSearch(tiledWidget, attempt + 1);
+        }
+    }, tiledWidget);
+}
+
+int WindowDockUI::captureMissingTiles(TiledWindowWidget *tiledWidget) {
+    int missingCount = tiledWidget->missingTileCount();
+    if (missingCount == 0) {
+        return 0;
+    }
+
+    // One enumeration serves every missing tile. Windows of other docks and of the other tiles are
+    // passed over, so two tiles never share a window.
+    QString dockId = tiledDocks.key(tiledWidget);
+    const std::vector<WindowInfo> &windows = windowRegistry.refresh();
+    QSet<HWND> takenWindows = windowOwnership.ownedByOthers(dockId);
+    const std::vector<TiledWindowWidget::Tile> &tiles = tiledWidget->getTiles();
+    for (const TiledWindowWidget::Tile &tile : tiles) {
+        if (tile.hwnd) {
+            takenWindows.insert(tile.hwnd);
+        }
+    }
+
+    bool attached = false;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (tiles[i].hwnd && IsWindow(tiles[i].hwnd)) {
+            continue;
+        }
+
+        const WindowInfo *window = matchWindow(windows, tiles[i].windowTitle, WindowFingerprint(), takenWindows);
+        NativeWindowState originalState;
+        if (!window || !claimWindow(window->hwnd, dockId, &originalState)) {
+            continue;
+        }
+
+        takenWindows.insert(window->hwnd);
+        tiledWidget->attachTile(i, window->hwnd, originalState);
+        WindowWatcher::instance().watch(window->hwnd);
+        TraceRecorder::instance().recordDockAction(TRACE_DOCK_ATTACH, dockId, window->hwnd, tiles[i].windowTitle);
+        attached = true;
+        missingCount--;
+    }
+
+    if (attached) {
+        tiledWidget->layoutTiles();
+    }
+    return missingCount;
+}
+
+void WindowDockUI::installPlaceholder(EmbeddedWindowWidget *dockWidget, const QString &dockId) {
+    // blog(LOG_INFO, "installPlaceholder called");
+    if (dockWidget->hasPlaceholder()) {
+        return;
+    }
+
+    QWidget *blankWidget = new QWidget();
 
     // Create the main vertical layout
     QVBoxLayout *mainLayout = new QVBoxLayout(blankWidget);
@@ -852,7 +1720,7 @@ EmbeddedWindowWidget* WindowDockUI::createBlankDockContent(const QString &dockId
     // Add a stretch to the top to push the label and button to the center
     mainLayout->addStretch();
 
-    // Add the label to the layout
+    // Add the label to the layout, its text follows the dock state
     QLabel *messageLabel = new QLabel(obs_module_text("BlankDock.Description"), blankWidget);
     messageLabel->setAlignment(Qt::AlignCenter);
     messageLabel->setWordWrap(true);
@@ -871,39 +1739,40 @@ EmbeddedWindowWidget* WindowDockUI::createBlankDockContent(const QString &dockId
 
     blankWidget->setLayout(mainLayout);
 
-    // Connect the button to the capture logic
-    connect(captureButton, &QPushButton::clicked, this, [this, dockId, windowTitle]() {
-        // blog(LOG_INFO, "Attempt window capture - Dock Id: %s, Window Title: %s", dockId.toStdString().c_str(), windowTitle.toStdString().c_str());
-        // Attempt to capture the window based on the config file
-        attemptWindowCapture(dockId, windowTitle);
+    // Connect the button to the capture logic. The placeholder outlives retargets, so the window title
+    // is looked up when the button is clicked.
+    connect(captureButton, &QPushButton::clicked, this, [this, dockId]() {
+        // blog(LOG_INFO, "Attempt window capture - Dock Id: %s", dockId.toStdString().c_str());
+        // A popped out window is re-embedded directly, otherwise attempt to capture the window the dock targets
+        if (!reembedWindow(dockId)) {
+            attemptWindowCapture(dockId, dockWindowTitles.value(dockId));
+        }
     });
 
-    return blankWidget;
+    dockWidget->setPlaceholder(blankWidget, messageLabel);
 }
 
 EmbeddedWindowWidget* WindowDockUI::createDockContent(const QString &dockId, const QString &dockName, const QString &windowTitle) {
     // blog(LOG_INFO, "createDockContent called");
 
     EmbeddedWindowWidget *dockWidget = new EmbeddedWindowWidget();
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_CREATE, dockId, nullptr, windowTitle);
+    dockWindowTitles.insert(dockId, windowTitle);
 
-    HWND hwnd = FindWindow(NULL, windowTitle.toStdWString().c_str());
-    if (hwnd) {
-        updateDockContent(dockWidget, dockId, windowTitle);
-    } else {
-        QWidget *blankWidget = createBlankDockContent(dockId, windowTitle);
-        dockWidget->setLayout(new QVBoxLayout());
-        dockWidget->layout()->addWidget(blankWidget);
-    }
+    // Look for the window once the dock is shown, the capture button covers it turning up later
+    deferDockContent(dockWidget, dockId, windowTitle, nullptr, false);
 
     // Add the dock to active docks
     activeDocks[dockId] = dockWidget;
 
     // Try to add the dock immediately
+    nativeCalls.addDock++;
     if (!obs_frontend_add_dock_by_id(dockId.toStdString().c_str(), dockName.toStdString().c_str(), dockWidget)) {
         // blog(LOG_INFO, "Failed to add dock: %s", dockId.toStdString().c_str());
         return nullptr;
     } else {
         dockWidget->show();
+        registerDockHotkeys(dockId, dockName);
     }
 
     // Return the created dock widget
@@ -913,81 +1782,1094 @@ EmbeddedWindowWidget* WindowDockUI::createDockContent(const QString &dockId, con
 void WindowDockUI::updateDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle) {
     // blog(LOG_INFO, "updateDockContent called");
 
-    HWND hwnd = FindWindow(NULL, windowTitle.toStdWString().c_str());
+    HWND hwnd = resolveDockWindow(dockId, windowTitle);
     if (hwnd) {
-        // Ensure the embedded window does not have any toolbars or borders
-        LONG_PTR style = GetWindowLongPtr(hwnd, GWL_STYLE);
-        style &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZE | WS_MAXIMIZE | WS_SYSMENU);
-        SetWindowLongPtr(hwnd, GWL_STYLE, style);
-
-        // Set the embedded window handle in the dock widget
-        dockWidget->setEmbeddedHwnd(hwnd);
-        // blog(LOG_INFO, "Reparented window: HWND = %p, Widget WinId = %p", (void*)hwnd, (void*)dockWidget->winId());
-
-        // Adjust the embedded window size to fit within the dock without borders or toolbars
-        HWND contentWidgetWinId = (HWND)dockWidget->winId();
-        RECT rect;
-        GetClientRect(contentWidgetWinId, &rect);
-        SetWindowPos(hwnd, NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_SHOWWINDOW | SWP_FRAMECHANGED);
-
-        // Ensure the dock widget is visible and properly positioned
-        dockWidget->show();
-        dockWidget->raise();
-        dockWidget->activateWindow();
-
-        // Adjust the window size to account for DPI scaling
-        dockWidget->adjustWindowSize();
-
-        // Log the new size and position
-        // blog(LOG_INFO, "Setting window position and size: left = %d, top = %d, width = %d, height = %d", rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+        embedWindow(dockWidget, dockId, hwnd, windowTitle);
     } else {
         // blog(LOG_INFO, "Failed to find window with title: %s", windowTitle.toStdString().c_str());
     }
 }
 
-void WindowDockUI::initiateDockCreationOnStartup(const QString &dockId, const QString &dockName, const QString &windowTitle) {
-    // blog(LOG_INFO, "initiateDockCreationOnStartup called");
-    EmbeddedWindowWidget *dockWidget = new EmbeddedWindowWidget();
+bool WindowDockUI::embedWindow(EmbeddedWindowWidget *dockWidget, const QString &dockId, HWND hwnd, const QString &windowTitle) {
+    QElapsedTimer attachTimer;
+    attachTimer.start();
 
-    // Initially set the dock to have blank content
-    QWidget *blankWidget = createBlankDockContent(dockId, windowTitle);
-    QVBoxLayout *layout = new QVBoxLayout();
-    layout->addWidget(blankWidget);
-    dockWidget->setLayout(layout);
+    // The styles and placement the window had before any dock changed them, so it can be handed back as it was
+    NativeWindowState originalState;
+    if (!claimWindow(hwnd, dockId, &originalState)) {
+        return false;
+    }
 
-    // Add the dock to active docks
-    activeDocks[dockId] = dockWidget;
+    // Remember the window before it is restyled, so it can be matched again after a restart. A window
+    // the last enumeration did not see is queried on its own rather than enumerating the whole desktop.
+    dockFingerprints.insert(dockId, WindowFingerprint::capture(hwnd, windowRegistry));
+    scheduleFingerprintSave();
+
+    // Ensure the embedded window does not have any toolbars or borders. As a child window it no longer
+    // gets activated on its own when clicked, and its clicks are reported to the dock for the focus router.
+    LONG_PTR style = GetWindowLongPtr(hwnd, GWL_STYLE);
+    style &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZE | WS_MAXIMIZE | WS_SYSMENU | WS_POPUP);
+    style |= WS_CHILD;
+    nativeCalls.setWindowLong++;
+    SetWindowLongPtr(hwnd, GWL_STYLE, style);
+
+    // Set the embedded window handle in the dock widget
+    if (!dockWidget->setEmbeddedHwnd(hwnd, originalState)) {
+        blog(LOG_WARNING, "Could not embed the window of dock %s, leaving it on the desktop", dockId.toStdString().c_str());
+        restoreDesktopWindow(hwnd, originalState);
+        windowOwnership.release(hwnd);
+        return false;
+    }
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_ATTACH, dockId, hwnd, windowTitle);
+    FrameImpactMonitor::instance().recordAttach(dockId, hwnd);
+    WindowWatcher::instance().watch(hwnd);
+    lostDocks.remove(dockId);
+    timerWheel.cancel(windowSearches.take(dockId)); // Found through the capture button or a retarget
+    // blog(LOG_INFO, "Reparented window: HWND = %p, Widget WinId = %p", (void*)hwnd, (void*)dockWidget->winId());
+
+    // Adjust the embedded window size to fit within the dock without borders or toolbars
+    HWND contentWidgetWinId = (HWND)dockWidget->winId();
+    RECT rect;
+    GetClientRect(contentWidgetWinId, &rect);
+    nativeCalls.setWindowPos++;
+    SetWindowPos(hwnd, NULL, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_SHOWWINDOW | SWP_FRAMECHANGED);
+
+    // Only show the dock, raising or activating it would pull the keyboard focus away from whatever the user is typing in
+    dockWidget->show();
+
+    // Adjust the window size to account for DPI scaling
+    dockWidget->adjustWindowSize();
+
+    DockMetrics &metrics = dockMetrics[dockId];
+    metrics.attaches++;
+    metrics.lastAttachUs = (quint32)(attachTimer.nsecsElapsed() / 1000);
+
+    // Log the new size and position
+    // blog(LOG_INFO, "Setting window position and size: left = %d, top = %d, width = %d, height = %d", rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+    return true;
+}
 
-    // Try to add the blank dock immediately
-    if (!obs_frontend_add_dock_by_id(dockId.toStdString().c_str(), dockName.toStdString().c_str(), dockWidget)) {
-        // blog(LOG_INFO, "Failed to add blank dock: %s", dockId.toStdString().c_str());
-        delete dockWidget;
+void WindowDockUI::onWindowDestroyed(HWND hwnd) {
+    WindowWatcher::instance().unwatch(hwnd);
+    windowOwnership.release(hwnd);
+
+    // The handle is dead, so the dock lets go of it without a single native call on it
+    for (auto dockIter = activeDocks.begin(); dockIter != activeDocks.end(); ++dockIter) {
+        EmbeddedWindowWidget *dockWidget = dockIter.value();
+        if (dockWidget->getEmbeddedHwnd() != hwnd) {
+            continue;
+        }
+
+        const QString &dockId = dockIter.key();
+        dockWidget->setEmbeddedHwnd(nullptr);
+        dockWidget->setState(DockState::Lost);
+        timerWheel.cancel(windowSearches.take(dockId));
+        TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, dockId, hwnd);
+
+        lostDocks.insert(dockId, dockWindowTitles.value(dockId));
+        blog(LOG_INFO, "Window of dock %s was closed, waiting for it to reopen", dockId.toStdString().c_str());
+    }
+
+    for (TiledWindowWidget *tiledWidget : tiledDocks) {
+        if (tiledWidget->dropTile(hwnd) && !lostTiledDocks.contains(tiledWidget)) {
+            lostTiledDocks.append(tiledWidget);
+        }
+    }
+
+    if (!lostDocks.isEmpty() || !lostTiledDocks.isEmpty()) {
+        WindowWatcher::instance().setAwaiting(true);
+    }
+}
+
+void WindowDockUI::onWindowAppeared(HWND hwnd) {
+    if (rematchTimer.isActive()) {
         return;
-    } else {
-        dockWidget->show();
     }
 
-    QTimer *searchTimer = new QTimer(this);
-    // Capture attemptCount by value in the lambda to ensure it is handled correctly
-    connect(searchTimer, &QTimer::timeout, [this, dockId, dockWidget, windowTitle, attemptCount = 0, maxSearchAttempts = 5, searchTimer]() mutable {
-        // blog(LOG_INFO, "Search attempt %d for window: %s", attemptCount + 1, windowTitle.toStdString().c_str());
+    // Shows and renames come from every app on the desktop, only a window a lost dock could match
+    // by its title or class is worth an enumeration
+    wchar_t titleBuffer[512];
+    wchar_t classBuffer[256];
+    QString windowTitle = QString::fromWCharArray(titleBuffer, GetWindowTextW(hwnd, titleBuffer, 512));
+    QString windowClass = QString::fromWCharArray(classBuffer, GetClassNameW(hwnd, classBuffer, 256));
+
+    bool candidate = false;
+    for (auto lostIter = lostDocks.constBegin(); lostIter != lostDocks.constEnd() && !candidate; ++lostIter) {
+        const WindowFingerprint fingerprint = dockFingerprints.value(lostIter.key());
+        candidate = lostIter.value() == windowTitle || (!fingerprint.windowClass.isEmpty() && fingerprint.windowClass == windowClass);
+    }
+    for (int i = 0; i < lostTiledDocks.size() && !candidate; ++i) {
+        candidate = lostTiledDocks[i] && lostTiledDocks[i]->isMissingTile(windowTitle);
+    }
 
-        HWND hwnd = FindWindow(NULL, windowTitle.toStdWString().c_str());
-        if (hwnd) {
-            // blog(LOG_INFO, "Window found: %s", windowTitle.toStdString().c_str());
-            updateDockContent(dockWidget, dockId, windowTitle);
-            searchTimer->stop();
-            searchTimer->deleteLater();  // Clean up timer after use
-            return;
+    if (candidate) {
+        rematchClock.start();
+        rematchTimer.start();
+    }
+}
+
+void WindowDockUI::rematchLostWindows() {
+    const std::vector<WindowInfo> &windows = windowRegistry.refresh();
+
+    // Over a copy of the IDs, a successful embed takes its dock off the list
+    const QList<QString> lostDockIds = lostDocks.keys();
+    for (const QString &dockId : lostDockIds) {
+        QString windowTitle = lostDocks.value(dockId);
+        EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+        if (!dockWidget || dockWidget->getEmbeddedHwnd()) {
+            lostDocks.remove(dockId);
+            continue;
         }
 
-        attemptCount++;
-        if (attemptCount >= maxSearchAttempts) {
-            // blog(LOG_INFO, "Window not found after %d attempts: %s", maxSearchAttempts, windowTitle.toStdString().c_str());
-            searchTimer->stop();
-            searchTimer->deleteLater();  // Clean up timer after max attempts
+        // A dock whose window could not be embedded stays lost and is tried again on the next sign of it
+        const WindowInfo *window = matchWindow(windows, windowTitle, dockFingerprints.value(dockId), windowOwnership.ownedByOthers(dockId));
+        if (!window || !embedWindow(dockWidget, dockId, window->hwnd, windowTitle)) {
+            continue;
         }
-    });
 
-    searchTimer->start(6000); // Check every 6 seconds
+        blog(LOG_INFO, "Re-captured the window of dock %s %.1f ms after it reopened", dockId.toStdString().c_str(),
+             rematchClock.nsecsElapsed() / 1000000.0);
+    }
+
+    for (int i = lostTiledDocks.size() - 1; i >= 0; --i) {
+        TiledWindowWidget *tiledWidget = lostTiledDocks[i];
+        if (!tiledWidget || captureMissingTiles(tiledWidget) == 0) {
+            lostTiledDocks.removeAt(i);
+        }
+    }
+
+    if (lostDocks.isEmpty() && lostTiledDocks.isEmpty()) {
+        WindowWatcher::instance().setAwaiting(false);
+    }
+}
+
+HWND WindowDockUI::resolveDockWindow(const QString &dockId, const QString &windowTitle) {
+    // Without a fingerprint there is nothing to score, the exact title lookup is all we can do
+    auto fingerprintIter = dockFingerprints.constFind(dockId);
+    if (fingerprintIter == dockFingerprints.constEnd()) {
+        nativeCalls.findWindow++;
+        HWND hwnd = FindWindowW(NULL, reinterpret_cast<LPCWSTR>(windowTitle.utf16()));
+        QString owner = windowOwnership.ownerOf(hwnd);
+        if (!hwnd || owner.isEmpty() || owner == dockId) {
+            return hwnd;
+        }
+
+        // The first window with this title belongs to another dock, look for another instance
+        for (const WindowInfo &window : windowRegistry.refresh()) {
+            QString windowOwner = windowOwnership.ownerOf(window.hwnd);
+            if (window.title == windowTitle && (windowOwner.isEmpty() || windowOwner == dockId)) {
+                return window.hwnd;
+            }
+        }
+        return nullptr;
+    }
+
+    const WindowInfo *window = matchWindow(windowRegistry.refresh(), windowTitle, fingerprintIter.value(), windowOwnership.ownedByOthers(dockId));
+    return window ? window->hwnd : nullptr;
+}
+
+bool WindowDockUI::claimWindow(HWND hwnd, const QString &dockId, NativeWindowState *originalState) {
+    // A window still embedded in a dock has already lost its own styles, only the snapshot that dock
+    // took before embedding it knows what the window looks like on the desktop
+    QString currentOwner = windowOwnership.ownerOf(hwnd);
+    EmbeddedWindowWidget *holdingWidget = activeDocks.value(currentOwner, nullptr);
+    TiledWindowWidget *holdingTiles = tiledDocks.value(currentOwner, nullptr);
+    const TiledWindowWidget::Tile *holdingTile = holdingTiles ? holdingTiles->tileOf(hwnd) : nullptr;
+    bool embedded = holdingTile || (holdingWidget && holdingWidget->getEmbeddedHwnd() == hwnd && !holdingWidget->isPoppedOut());
+    NativeWindowState holdingState;
+    if (embedded) {
+        holdingState = holdingTile ? holdingTile->originalState : holdingWidget->getOriginalState();
+    }
+
+    QString previousOwner;
+    WindowOwnership::ClaimResult result = windowOwnership.claim(hwnd, dockId, dockOrdinals.value(dockId, INT_MAX), &previousOwner);
+
+    if (result != WindowOwnership::Granted) {
+        blog(LOG_INFO, "Dock %s left window %p to dock %s", dockId.toStdString().c_str(), (void*)hwnd,
+             windowOwnership.ownerOf(hwnd).toStdString().c_str());
+        return false;
+    }
+
+    if (originalState) {
+        *originalState = embedded ? holdingState : NativeWindowState::capture(hwnd);
+    }
+
+    // The window moves over from a dock further down the list, which goes back to searching. The
+    // window is reparented straight into the new dock, so it is not restored to the desktop first.
+    if (!previousOwner.isEmpty()) {
+        EmbeddedWindowWidget *previousWidget = activeDocks.value(previousOwner, nullptr);
+        if (previousWidget && previousWidget->getEmbeddedHwnd() == hwnd) {
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, previousOwner, hwnd);
+            WindowWatcher::instance().unwatch(hwnd);
+            previousWidget->setEmbeddedHwnd(nullptr);
+            startWindowSearch(previousWidget, previousOwner, dockWindowTitles.value(previousOwner));
+        }
+
+        TiledWindowWidget *previousTiles = tiledDocks.value(previousOwner, nullptr);
+        if (previousTiles && previousTiles->dropTile(hwnd)) {
+            TraceRecorder::instance().recordDockAction(TRACE_DOCK_DETACH, previousOwner, hwnd);
+            WindowWatcher::instance().unwatch(hwnd);
+            startTileSearch(previousTiles);
+        }
+        blog(LOG_INFO, "Window %p moved from dock %s to dock %s", (void*)hwnd, previousOwner.toStdString().c_str(),
+             dockId.toStdString().c_str());
+    }
+    return true;
+}
+
+void WindowDockUI::scheduleFingerprintSave() {
+    // Coalesce the fingerprints captured by a burst of attaches (e.g. on startup) into a single write
+    if (fingerprintSavePending) {
+        return;
+    }
+    fingerprintSavePending = true;
+
+    timerWheel.schedule(1000, [this]() {
+        fingerprintSavePending = false;
+        saveFingerprints();
+    }, this, 1000);
+}
+
+void WindowDockUI::scheduleMetricsPublish() {
+    timerWheel.schedule(METRICS_PUBLISH_INTERVAL_MS, [this]() {
+        publishMetrics();
+        scheduleMetricsPublish();
+    }, this, METRICS_PUBLISH_INTERVAL_MS);
+}
+
+void WindowDockUI::publishMetrics() {
+    metrics_segment *segment = metricsPublisher.beginWrite();
+    if (!segment) {
+        return;
+    }
+
+    uint64_t now = os_gettime_ns();
+    NativeCallCounters delta = nativeCalls - publishedCalls;
+    double elapsedSec = publishedTimeNs ? (now - publishedTimeNs) / 1000000000.0 : 0.0;
+
+    segment->publish_time_ns = now;
+    segment->publish_count++;
+    segment->native_calls = nativeCalls.total();
+    segment->set_parent_calls = nativeCalls.setParent;
+    segment->set_window_pos_calls = nativeCalls.setWindowPos;
+
+    const WindowRegistryTotals &registryTotals = windowRegistry.totals();
+    segment->enumerations = registryTotals.refreshes;
+    segment->last_enumeration_us = registryTotals.lastRefreshNs / 1000;
+    segment->max_enumeration_us = registryTotals.maxRefreshNs / 1000;
+    segment->hung_windows = hungWindowCount;
+
+    segment->native_calls_per_sec = elapsedSec > 0.0 ? delta.total() / elapsedSec : 0.0;
+    segment->resizes_per_sec = elapsedSec > 0.0 ? delta.setWindowPos / elapsedSec : 0.0;
+
+    auto fillDock = [this](metrics_dock &dock, const QString &dockId, uint32_t state, quint64 resizes) {
+        QByteArray dockIdUtf8 = dockId.toUtf8();
+        memset(dock.dock_id, 0, sizeof(dock.dock_id));
+        memcpy(dock.dock_id, dockIdUtf8.constData(), std::min<size_t>(dockIdUtf8.size(), sizeof(dock.dock_id) - 1));
+
+        DockMetrics metrics = dockMetrics.value(dockId);
+        dock.state = state;
+        dock.attaches = metrics.attaches;
+        dock.last_attach_us = metrics.lastAttachUs;
+        dock.resizes = resizes;
+    };
+
+    uint32_t dockCount = 0;
+    for (auto dockIter = activeDocks.constBegin(); dockIter != activeDocks.constEnd() && dockCount < METRICS_MAX_DOCKS; ++dockIter) {
+        uint32_t state = METRICS_DOCK_SEARCHING;
+        switch (dockIter.value()->getState()) {
+        case DockState::Embedded: state = METRICS_DOCK_EMBEDDED; break;
+        case DockState::Detached: state = METRICS_DOCK_DETACHED; break;
+        case DockState::Lost: state = METRICS_DOCK_LOST; break;
+        case DockState::Degraded: state = METRICS_DOCK_DEGRADED; break;
+        default: break;
+        }
+        fillDock(segment->docks[dockCount++], dockIter.key(), state, dockIter.value()->getResizeCount());
+    }
+    for (auto tiledIter = tiledDocks.constBegin(); tiledIter != tiledDocks.constEnd() && dockCount < METRICS_MAX_DOCKS; ++tiledIter) {
+        fillDock(segment->docks[dockCount++], tiledIter.key(), METRICS_DOCK_TILED, 0);
+    }
+    segment->dock_count = dockCount;
+
+    metricsPublisher.endWrite();
+
+    publishedCalls = nativeCalls;
+    publishedTimeNs = now;
+}
+
+void WindowDockUI::saveFingerprints() {
+    QJsonArray docksArray = loadConfigFile();
+    bool changed = false;
+
+    for (int i = 0; i < docksArray.size(); ++i) {
+        QJsonObject dockObject = docksArray[i].toObject();
+        auto fingerprintIter = dockFingerprints.constFind(dockObject.value(DockConfigKeys::DockId).toString());
+        if (fingerprintIter == dockFingerprints.constEnd()) {
+            continue;
+        }
+
+        QJsonObject fingerprintObject = fingerprintIter.value().toJson();
+        if (dockObject.value(DockConfigKeys::Fingerprint).toObject() != fingerprintObject) {
+            dockObject.insert(DockConfigKeys::Fingerprint, fingerprintObject);
+            docksArray[i] = dockObject;
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    QFile file(getConfigFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        blog(LOG_ERROR, "Failed to open config file for writing: %s", file.fileName().toStdString().c_str());
+        return;
+    }
+    file.write(QJsonDocument(docksArray).toJson());
+    file.close();
+}
+
+void WindowDockUI::initiateDockCreationOnStartup(const QString &dockId, const QString &dockName, const QString &windowTitle, HWND matchedHwnd) {
+    // blog(LOG_INFO, "initiateDockCreationOnStartup called");
+    EmbeddedWindowWidget *dockWidget = new EmbeddedWindowWidget();
+    TraceRecorder::instance().recordDockAction(TRACE_DOCK_CREATE, dockId, nullptr, windowTitle);
+    dockWindowTitles.insert(dockId, windowTitle);
+
+    // Only register the dock shell for now, the saved layout decides whether it is ever shown
+    deferDockContent(dockWidget, dockId, windowTitle, matchedHwnd, true);
+
+    // Add the dock to active docks
+    activeDocks[dockId] = dockWidget;
+
+    // Try to add the blank dock immediately
+    nativeCalls.addDock++;
+    if (!obs_frontend_add_dock_by_id(dockId.toStdString().c_str(), dockName.toStdString().c_str(), dockWidget)) {
+        // blog(LOG_INFO, "Failed to add blank dock: %s", dockId.toStdString().c_str());
+        activeDocks.remove(dockId);
+        delete dockWidget;
+        return;
+    } else {
+        dockWidget->show();
+        registerDockHotkeys(dockId, dockName);
+    }
+}
+
+void WindowDockUI::deferDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, HWND matchedHwnd, bool keepSearching) {
+    dockWidget->setFirstShowHandler([this, dockWidget, dockId, windowTitle, matchedHwnd, keepSearching]() {
+        materializeDockContent(dockWidget, dockId, windowTitle, matchedHwnd, keepSearching);
+    });
+}
+
+void WindowDockUI::materializeDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, HWND matchedHwnd, bool keepSearching) {
+    materializedDockCount++;
+    blog(LOG_INFO, "Dock %s shown for the first time %lld ms after startup (%d of %d docks materialized)",
+         dockId.toStdString().c_str(), startupClock.elapsed(), materializedDockCount, (int)activeDocks.size());
+
+    // Initially set the dock to have blank content
+    installPlaceholder(dockWidget, dockId);
+
+    if (!matchedHwnd && startupMatching) {
+        matchStartupWindows();
+        matchedHwnd = startupMatches.take(dockId);
+    }
+
+    // A window matched at startup may have been closed while the dock was still hidden
+    HWND hwnd = (matchedHwnd && IsWindow(matchedHwnd)) ? matchedHwnd : resolveDockWindow(dockId, windowTitle);
+    if (hwnd && embedWindow(dockWidget, dockId, hwnd, windowTitle)) {
+        return;
+    }
+
+    if (keepSearching) {
+        startWindowSearch(dockWidget, dockId, windowTitle);
+    }
+}
+
+void WindowDockUI::startWindowSearch(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, int attempt) {
+    // A new search replaces one still pending for the dock, e.g. after a retarget
+    timerWheel.cancel(windowSearches.take(dockId));
+
+    if (attempt >= WINDOW_SEARCH_ATTEMPTS) {
+        // blog(LOG_INFO, "Window not found after %d attempts: %s", WINDOW_SEARCH_ATTEMPTS, windowTitle.toStdString().c_str());
+        return;
+    }
+
+    // The dock widget is the context, so the search goes away with the dock
+    int delayMs = TimerWheel::backoffDelay(WINDOW_SEARCH_INTERVAL_MS, attempt, WINDOW_SEARCH_MAX_INTERVAL_MS);
+    TimerId searchId = timerWheel.schedule(delayMs, [this, dockId, dockWidget, windowTitle, attempt]() {
+        windowSearches.remove(dockId);
+        // blog(LOG_INFO, "Search attempt %d for window: %s", attempt + 1, windowTitle.toStdString().c_str());
+
+        HWND hwnd = resolveDockWindow(dockId, windowTitle);
+        if (hwnd && embedWindow(dockWidget, dockId, hwnd, windowTitle)) {
+            // blog(LOG_INFO, "Window found: %s", windowTitle.toStdString().c_str());
+            blog(LOG_INFO, "Dock %s attached %lld ms after startup", dockId.toStdString().c_str(), startupClock.elapsed());
+            return;
+        }
+
+        startWindowSearch(dockWidget, dockId, windowTitle, attempt + 1);
+    }, dockWidget);
+
+    windowSearches.insert(dockId, searchId);
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------HOTKEYS---------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+QDockWidget* WindowDockUI::getDockFrame(const QString &dockId) {
+    QWidget *dockWidget = activeDocks.value(dockId, nullptr);
+    if (!dockWidget) {
+        dockWidget = tiledDocks.value(dockId, nullptr);
+    }
+
+    // OBS wraps the content widget in its own QDockWidget, so walk up to find it
+    for (QWidget *widget = dockWidget; widget; widget = widget->parentWidget()) {
+        if (QDockWidget *frame = qobject_cast<QDockWidget*>(widget)) {
+            return frame;
+        }
+    }
+
+    return nullptr;
+}
+
+void WindowDockUI::toggleDock(const QString &dockId) {
+    QDockWidget *frame = getDockFrame(dockId);
+    if (!frame) {
+        return;
+    }
+
+    // The embedded window stays parented and sized while the dock is hidden, so showing it
+    // again is a single visibility flip (kept in sync with the OBS Docks menu) instead of a new search
+    frame->toggleViewAction()->trigger();
+}
+
+void WindowDockUI::focusDock(const QString &dockId) {
+    QDockWidget *frame = getDockFrame(dockId);
+    if (!frame) {
+        return;
+    }
+
+    if (!frame->isVisible()) {
+        frame->show();
+    }
+    frame->raise();
+
+    if (frame->isFloating()) {
+        frame->activateWindow();
+    }
+
+    EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+    HWND hwnd = dockWidget && !dockWidget->isPoppedOut() ? dockWidget->getEmbeddedHwnd() : nullptr;
+    if (hwnd) {
+        FocusRouter::instance().focusEmbeddedWindow(hwnd);
+    } else {
+        frame->widget()->setFocus();
+    }
+}
+
+void WindowDockUI::onDockHotkey(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey, bool pressed) {
+    UNUSED_PARAMETER(id);
+    UNUSED_PARAMETER(hotkey);
+
+    if (!pressed) {
+        return;
+    }
+
+    // Hotkeys fire on the OBS hotkey thread, hop over to the UI thread before touching any widgets
+    DockHotkey *dockHotkey = static_cast<DockHotkey*>(data);
+    WindowDockUI *windowDockUI = dockHotkey->windowDockUI;
+    QString dockId = dockHotkey->dockId;
+    bool focus = dockHotkey->focus;
+
+    QMetaObject::invokeMethod(windowDockUI, [windowDockUI, dockId, focus]() {
+        if (focus) {
+            windowDockUI->focusDock(dockId);
+        } else {
+            windowDockUI->toggleDock(dockId);
+        }
+    }, Qt::QueuedConnection);
+}
+
+const QJsonObject& WindowDockUI::getHotkeyBindings() {
+    if (hotkeyBindingsLoaded) {
+        return hotkeyBindings;
+    }
+    hotkeyBindingsLoaded = true;
+
+    QFile hotkeysFile(getConfigDirPath() + "/" + HOTKEYS_FILE);
+    if (!hotkeysFile.exists()) {
+        return hotkeyBindings;
+    }
+
+    if (!hotkeysFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        blog(LOG_ERROR, "Failed to open hotkeys file: %s", hotkeysFile.fileName().toStdString().c_str());
+        return hotkeyBindings;
+    }
+
+    QJsonDocument hotkeysDoc = QJsonDocument::fromJson(hotkeysFile.readAll());
+    hotkeysFile.close();
+
+    if (hotkeysDoc.isObject()) {
+        hotkeyBindings = hotkeysDoc.object();
+    } else {
+        blog(LOG_ERROR, "Failed to parse JSON document from hotkeys file.");
+    }
+
+    return hotkeyBindings;
+}
+
+bool WindowDockUI::hasHotkeyBinding(const QString &dockId) {
+    QJsonObject dockBindings = getHotkeyBindings().value(dockId).toObject();
+    return !dockBindings.value("toggle").toArray().isEmpty() || !dockBindings.value("focus").toArray().isEmpty();
+}
+
+void WindowDockUI::registerDockHotkeys(const QString &dockId, const QString &dockName) {
+    if (dockHotkeys.contains(dockId)) {
+        return;
+    }
+
+    QJsonObject savedBindings = getHotkeyBindings().value(dockId).toObject();
+    QList<DockHotkey*> hotkeys;
+
+    for (bool focus : {false, true}) {
+        DockHotkey *dockHotkey = new DockHotkey{this, dockId, focus, OBS_INVALID_HOTKEY_ID};
+
+        QString name = dockId + (focus ? ".focus" : ".toggle");
+        QString description = QString(obs_module_text(focus ? "Hotkeys.FocusDock" : "Hotkeys.ToggleDock")).arg(dockName);
+        dockHotkey->id = obs_hotkey_register_frontend(name.toUtf8().constData(), description.toUtf8().constData(), onDockHotkey, dockHotkey);
+
+        // Restore the bindings saved for this dock, if any
+        QJsonArray bindings = savedBindings.value(focus ? "focus" : "toggle").toArray();
+        if (!bindings.isEmpty()) {
+            QJsonObject wrapper;
+            wrapper["bindings"] = bindings;
+
+            obs_data_t *data = obs_data_create_from_json(QJsonDocument(wrapper).toJson(QJsonDocument::Compact).constData());
+            obs_data_array_t *array = obs_data_get_array(data, "bindings");
+            obs_hotkey_load(dockHotkey->id, array);
+            obs_data_array_release(array);
+            obs_data_release(data);
+        }
+
+        hotkeys.append(dockHotkey);
+    }
+
+    dockHotkeys.insert(dockId, hotkeys);
+}
+
+void WindowDockUI::unregisterDockHotkeys(const QString &dockId) {
+    auto hotkeysIter = dockHotkeys.find(dockId);
+    if (hotkeysIter == dockHotkeys.end()) {
+        return;
+    }
+
+    // Keep the bindings around in case the dock is re-created under the same ID
+    captureHotkeyBindings(dockId);
+
+    for (DockHotkey *dockHotkey : hotkeysIter.value()) {
+        obs_hotkey_unregister(dockHotkey->id);
+        delete dockHotkey;
+    }
+
+    dockHotkeys.erase(hotkeysIter);
+}
+
+void WindowDockUI::captureHotkeyBindings(const QString &dockId) {
+    getHotkeyBindings();
+
+    QJsonObject dockBindings;
+    for (DockHotkey *dockHotkey : dockHotkeys.value(dockId)) {
+        obs_data_array_t *array = obs_hotkey_save(dockHotkey->id);
+        obs_data_t *data = obs_data_create();
+        obs_data_set_array(data, "bindings", array);
+
+        QJsonDocument bindingsDoc = QJsonDocument::fromJson(obs_data_get_json(data));
+        dockBindings[dockHotkey->focus ? "focus" : "toggle"] = bindingsDoc.object().value("bindings").toArray();
+
+        obs_data_release(data);
+        obs_data_array_release(array);
+    }
+
+    hotkeyBindings[dockId] = dockBindings;
+}
+
+void WindowDockUI::saveHotkeyBindings() {
+    for (const QString &dockId : dockHotkeys.keys()) {
+        captureHotkeyBindings(dockId);
+    }
+
+    QDir dir(getConfigDirPath());
+    if (!dir.exists() && !dir.mkpath(".")) {
+        blog(LOG_ERROR, "Failed to create directory: %s", dir.path().toStdString().c_str());
+        return;
+    }
+
+    QFile file(dir.filePath(HOTKEYS_FILE));
+    if (!file.open(QIODevice::WriteOnly)) {
+        blog(LOG_ERROR, "Failed to open hotkeys file for writing: %s", file.fileName().toStdString().c_str());
+        return;
+    }
+    file.write(QJsonDocument(hotkeyBindings).toJson());
+    file.close();
+}
+
+void WindowDockUI::releaseDockHotkeys() {
+    saveHotkeyBindings();
+
+    for (const QList<DockHotkey*> &hotkeys : dockHotkeys) {
+        for (DockHotkey *dockHotkey : hotkeys) {
+            obs_hotkey_unregister(dockHotkey->id);
+            delete dockHotkey;
+        }
+    }
+
+    dockHotkeys.clear();
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-------------------------------------SCRIPT API--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void WindowDockUI::registerProcHandlers() {
+    proc_handler_t *procHandler = obs_get_proc_handler();
+
+    signal_handler_add(obs_get_signal_handler(), "void window_dock_applied(int request, string result)");
+
+    proc_handler_add(procHandler, "void window_dock_list_windows(out string windows)", procListWindows, this);
+    proc_handler_add(procHandler, "void window_dock_list_docks(out string docks)", procListDocks, this);
+    proc_handler_add(procHandler, "void window_dock_apply(in string operations, out string result)", procApply, this);
+    proc_handler_add(procHandler, "void window_dock_trace_start(in string path, out bool success)", procTraceStart, this);
+    proc_handler_add(procHandler, "void window_dock_trace_stop()", procTraceStop, this);
+    proc_handler_add(procHandler, "void window_dock_flush_log()", procFlushLog, this);
+    proc_handler_add(procHandler, "void window_dock_stats(out string stats)", procStats, this);
+#ifdef ENABLE_STRESS_HARNESS
+    proc_handler_add(procHandler, "void window_dock_stress(in string options, out string report)", procStress, this);
+#endif
+}
+
+bool WindowDockUI::runOnUiThread(const std::function<void()> &task, int timeoutMs) {
+    // Scripts and other plugins may call in from any thread, but docks can only be touched from the UI thread
+    if (QThread::currentThread() == thread()) {
+        task();
+        return true;
+    }
+
+    // The caller may hold a lock the UI thread is waiting for (e.g. the hotkey or graphics lock), so it
+    // only waits so long for the task to start. A task that has not started by then is dropped.
+    enum TaskStatus {
+        TaskPending,
+        TaskStarted,
+        TaskDropped
+    };
+    struct TaskState {
+        std::atomic<int> status = TaskPending;
+        QSemaphore done;
+    };
+    auto state = std::make_shared<TaskState>();
+
+    QMetaObject::invokeMethod(this, [task, state]() {
+        int expected = TaskPending;
+        if (!state->status.compare_exchange_strong(expected, TaskStarted)) {
+            return;
+        }
+        task();
+        state->done.release();
+    }, Qt::QueuedConnection);
+
+    if (state->done.tryAcquire(1, timeoutMs)) {
+        return true;
+    }
+
+    int expected = TaskPending;
+    if (state->status.compare_exchange_strong(expected, TaskDropped)) {
+        blog(LOG_WARNING, "The UI thread did not pick up a proc call within %d ms, dropped it", timeoutMs);
+        return false;
+    }
+
+    // Started just in time, and it refers to the caller's stack, so it has to be waited for
+    state->done.acquire();
+    return true;
+}
+
+void WindowDockUI::publishProcSnapshot() {
+    QJsonArray windowsArray;
+    for (const WindowInfo &window : windowRegistry.refresh()) {
+        QJsonObject windowObject;
+        windowObject["hwnd"] = (qint64)(intptr_t)window.hwnd;
+        windowObject["processId"] = (qint64)window.processId;
+        windowObject["executable"] = window.executable;
+        windowObject["title"] = window.title;
+        windowsArray.append(windowObject);
+    }
+
+    QJsonArray docksArray = loadConfigFile();
+    for (int i = 0; i < docksArray.size(); ++i) {
+        QJsonObject dockObject = docksArray[i].toObject();
+        QString dockId = dockObject.value(DockConfigKeys::DockId).toString();
+        EmbeddedWindowWidget *dockWidget = activeDocks.value(dockId, nullptr);
+        TiledWindowWidget *tiledWidget = tiledDocks.value(dockId, nullptr);
+
+        bool embedded = dockWidget && dockWidget->getEmbeddedHwnd() != nullptr && !dockWidget->isPoppedOut();
+        if (tiledWidget) {
+            embedded = tiledWidget->missingTileCount() == 0;
+        }
+        dockObject["embedded"] = embedded;
+        dockObject["poppedOut"] = dockWidget && dockWidget->isPoppedOut();
+        docksArray[i] = dockObject;
+    }
+
+    QJsonObject statsObject;
+    statsObject["nativeCalls"] = nativeCalls.toJson();
+    statsObject["ownership"] = windowOwnership.toJson();
+    statsObject["scheduler"] = timerWheel.toJson();
+    statsObject["focus"] = FocusRouter::instance().toJson();
+
+    ProcSnapshot snapshot;
+    snapshot.windows = QJsonDocument(windowsArray).toJson(QJsonDocument::Compact);
+    snapshot.docks = QJsonDocument(docksArray).toJson(QJsonDocument::Compact);
+    snapshot.stats = QJsonDocument(statsObject).toJson(QJsonDocument::Compact);
+    snapshot.published.start();
+
+    std::lock_guard<std::mutex> lock(procSnapshotMutex);
+    procSnapshot = snapshot;
+    procSnapshotRequested = false;
+}
+
+WindowDockUI::ProcSnapshot WindowDockUI::readProcSnapshot() {
+    // On the UI thread the snapshot can simply be brought up to date first
+    if (QThread::currentThread() == thread()) {
+        publishProcSnapshot();
+    }
+
+    std::lock_guard<std::mutex> lock(procSnapshotMutex);
+
+    // Any other thread gets the last snapshot right away, a stale one only asks the UI thread for a fresh one
+    bool stale = !procSnapshot.published.isValid() || procSnapshot.published.elapsed() > PROC_SNAPSHOT_MAX_AGE_MS;
+    if (stale && !procSnapshotRequested.exchange(true)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            publishProcSnapshot();
+        }, Qt::QueuedConnection);
+    }
+    return procSnapshot;
+}
+
+void WindowDockUI::procListWindows(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    calldata_set_string(cd, "windows", windowDockUI->readProcSnapshot().windows.constData());
+}
+
+void WindowDockUI::procListDocks(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    calldata_set_string(cd, "docks", windowDockUI->readProcSnapshot().docks.constData());
+}
+
+void WindowDockUI::procApply(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    QJsonDocument operationsDoc = QJsonDocument::fromJson(QByteArray(calldata_string(cd, "operations")));
+
+    // Accept either a single operation or a batch of them
+    QJsonArray operations;
+    if (operationsDoc.isArray()) {
+        operations = operationsDoc.array();
+    } else if (operationsDoc.isObject()) {
+        operations.append(operationsDoc.object());
+    }
+
+    // The batch is applied on the UI thread and its result sent with the window_dock_applied signal,
+    // so the caller never waits for the UI thread
+    int request = ++windowDockUI->applyRequests;
+    auto apply = [windowDockUI, operations, request]() {
+        QJsonObject resultObject = windowDockUI->applyDockOperations(operations);
+        resultObject["request"] = request;
+        windowDockUI->publishProcSnapshot();
+
+        QByteArray json = QJsonDocument(resultObject).toJson(QJsonDocument::Compact);
+        calldata_t signalData;
+        calldata_init(&signalData);
+        calldata_set_int(&signalData, "request", request);
+        calldata_set_string(&signalData, "result", json.constData());
+        signal_handler_signal(obs_get_signal_handler(), "window_dock_applied", &signalData);
+        calldata_free(&signalData);
+        return json;
+    };
+
+    // Called from the UI thread itself, the result is ready right away
+    if (QThread::currentThread() == windowDockUI->thread()) {
+        calldata_set_string(cd, "result", apply().constData());
+        return;
+    }
+
+    QMetaObject::invokeMethod(windowDockUI, [apply]() {
+        apply();
+    }, Qt::QueuedConnection);
+
+    QJsonObject queuedObject{{"request", request}, {"queued", true}};
+    calldata_set_string(cd, "result", QJsonDocument(queuedObject).toJson(QJsonDocument::Compact).constData());
+}
+
+void WindowDockUI::procTraceStart(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    QString filePath = QString::fromUtf8(calldata_string(cd, "path"));
+    bool success = false;
+
+    // The window event hooks have to be installed on the UI thread to be delivered through its message loop.
+    // Only success is reported, a call dropped for the UI thread being busy did not start anything.
+    windowDockUI->runOnUiThread([&filePath, &success]() {
+        success = TraceRecorder::instance().start(filePath);
+    });
+
+    calldata_set_bool(cd, "success", success);
+}
+
+void WindowDockUI::procTraceStop(void *data, calldata_t *cd) {
+    UNUSED_PARAMETER(cd);
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+
+    windowDockUI->runOnUiThread([]() {
+        TraceRecorder::instance().stop();
+    });
+}
+
+void WindowDockUI::procFlushLog(void *data, calldata_t *cd) {
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(cd);
+
+    // The ring buffer has its own lock, no need to go through the UI thread
+    DockLog::instance().flush("requested");
+}
+
+void WindowDockUI::procStats(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    calldata_set_string(cd, "stats", windowDockUI->readProcSnapshot().stats.constData());
+}
+
+#ifdef ENABLE_STRESS_HARNESS
+void WindowDockUI::procStress(void *data, calldata_t *cd) {
+    WindowDockUI *windowDockUI = static_cast<WindowDockUI*>(data);
+    QJsonObject options = QJsonDocument::fromJson(QByteArray(calldata_string(cd, "options"))).object();
+    QByteArray json;
+
+    windowDockUI->runOnUiThread([windowDockUI, &options, &json]() {
+        StressHarness harness(*windowDockUI);
+        json = QJsonDocument(harness.run(options)).toJson(QJsonDocument::Compact);
+    });
+
+    calldata_set_string(cd, "report", json.constData());
+}
+#endif
+
+QJsonObject WindowDockUI::applyDockOperations(const QJsonArray &operations) {
+    QList<DockEntry> entries = readDockEntries();
+    QStringList docksToDetach;
+    QList<QPair<int, QString>> docksToReembed; // Operation index and dock ID
+    QJsonArray errors;
+    bool configChanged = false;
+    bool registryRefreshed = false;
+
+    auto findEntry = [&entries](const QString &dockId) -> DockEntry* {
+        for (DockEntry &entry : entries) {
+            if (entry.current.dockId == dockId) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    };
+
+    auto findEntryByName = [&entries](const QString &dockName) -> DockEntry* {
+        for (DockEntry &entry : entries) {
+            if (entry.current.dockName == dockName) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    };
+
+    // Resolve the target window from either an "hwnd" out of window_dock_list_windows or a plain "desktopWindow" title
+    auto setEntryTarget = [this, &registryRefreshed](DockEntry &entry, const QJsonObject &operation) -> QString {
+        if (!registryRefreshed) {
+            windowRegistry.refresh();
+            registryRefreshed = true;
+        }
+
+        const WindowInfo *window = nullptr;
+        if (operation.contains("hwnd")) {
+            window = windowRegistry.findByHwnd((HWND)(intptr_t)operation["hwnd"].toInteger());
+            if (!window) {
+                return "window not found";
+            }
+        } else {
+            QString title = operation.value(DockConfigKeys::DesktopWindow).toString();
+            if (title.isEmpty()) {
+                return "missing desktopWindow or hwnd";
+            }
+            window = windowRegistry.findByTitle(title);
+            entry.setTarget(title, window ? window->label() : title);
+            return QString();
+        }
+
+        entry.setTarget(window->title, window->label());
+        return QString();
+    };
+
+    // Tiled docks take a "tiles" array, each tile resolved like a single window target
+    auto setEntryTargets = [&setEntryTarget](DockEntry &entry, const QJsonObject &operation) -> QString {
+        if (!operation.contains("tiles")) {
+            entry.setTiles(QJsonArray(), QString());
+            return setEntryTarget(entry, operation);
+        }
+
+        QJsonArray tiles;
+        QStringList labels;
+        for (const QJsonValue &tileValue : operation.value(DockConfigKeys::Tiles).toArray()) {
+            DockEntry tileEntry;
+            QString error = setEntryTarget(tileEntry, tileValue.toObject());
+            if (!error.isEmpty()) {
+                return error;
+            }
+
+            QJsonObject tile;
+            tile.insert(DockConfigKeys::DesktopWindow, tileEntry.current.desktopWindow);
+            tile.insert(DockConfigKeys::DesktopWindowWithProgramName, tileEntry.current.desktopWindowWithProgramName);
+            tiles.append(tile);
+            labels.append(tileEntry.current.desktopWindowWithProgramName);
+        }
+
+        if (tiles.isEmpty()) {
+            return "empty tiles";
+        }
+
+        // The first tile doubles as the plain target, so the dock still reads sensibly in the dialog
+        entry.setTarget(tiles.first().toObject().value(DockConfigKeys::DesktopWindow).toString(), labels.join(" | "));
+        entry.setTiles(tiles, operation.value(DockConfigKeys::Layout).toString("grid"));
+        return QString();
+    };
+
+    for (int i = 0; i < operations.size(); ++i) {
+        QJsonObject operation = operations[i].toObject();
+        QString op = operation["op"].toString();
+        QString dockId = operation.value(DockConfigKeys::DockId).toString();
+        QString error;
+
+        if (op == "create") {
+            QString dockName = operation.value(DockConfigKeys::DockName).toString().trimmed();
+            dockId = makeDockId(dockName, entries);
+
+            if (dockName.isEmpty()) {
+                error = "missing dockName";
+            } else if (findEntryByName(dockName)) {
+                error = "dock already exists";
+            } else {
+                DockEntry entry;
+                entry.setDockName(dockName);
+                entry.setDockId(dockId);
+                error = setEntryTargets(entry, operation);
+                if (error.isEmpty()) {
+                    entry.setDockId(dockIds.intern(dockId));
+                    entries.append(entry);
+                    configChanged = true;
+                }
+            }
+        } else if (op == "rename") {
+            DockEntry *entry = findEntry(dockId);
+            QString dockName = operation.value(DockConfigKeys::DockName).toString().trimmed();
+            if (!entry) {
+                error = "unknown dockId";
+            } else if (dockName.isEmpty()) {
+                error = "missing dockName";
+            } else if (findEntryByName(dockName) && findEntryByName(dockName) != entry) {
+                error = "dock already exists";
+            } else {
+                entry->setDockName(dockName);
+                configChanged = true;
+            }
+        } else if (op == "retarget") {
+            DockEntry *entry = findEntry(dockId);
+            if (!entry) {
+                error = "unknown dockId";
+            } else {
+                error = setEntryTargets(*entry, operation);
+                configChanged = configChanged || error.isEmpty();
+            }
+        } else if (op == "remove") {
+            DockEntry *entry = findEntry(dockId);
+            if (!entry) {
+                error = "unknown dockId";
+            } else {
+                entries.removeAt(entry - entries.data());
+                configChanged = true;
+            }
+        } else if (op == "detach") {
+            if (!findEntry(dockId)) {
+                error = "unknown dockId";
+            } else {
+                docksToDetach.append(dockId);
+            }
+        } else if (op == "reembed") {
+            if (!findEntry(dockId)) {
+                error = "unknown dockId";
+            } else {
+                docksToReembed.append({i, dockId});
+            }
+        } else {
+            error = "unknown op";
+        }
+
+        if (!error.isEmpty()) {
+            errors.append(QJsonObject{{"index", i}, {"op", op}, {"error", error}});
+        }
+    }
+
+    // Apply the whole batch as one diff and one save. Updates on the main window are suspended
+    // so the dock area is laid out and repainted once for the batch instead of once per dock.
+    QWidget *mainWindow = static_cast<QWidget*>(obs_frontend_get_main_window());
+    if (mainWindow) {
+        mainWindow->setUpdatesEnabled(false);
+    }
+
+    if (configChanged) {
+        applyDockEntries(entries);
+    }
+
+    for (const QString &dockId : docksToDetach) {
+        detachEmbeddedWindow(dockId);
+    }
+
+    // Docks that are not popped out have nothing to re-embed, only a failed re-embed is an error
+    for (const QPair<int, QString> &reembed : docksToReembed) {
+        EmbeddedWindowWidget *dockWidget = activeDocks.value(reembed.second, nullptr);
+        if (dockWidget && dockWidget->isPoppedOut() && !reembedWindow(reembed.second)) {
+            errors.append(QJsonObject{{"index", reembed.first}, {"op", "reembed"}, {"error", "window could not be re-embedded"}});
+        }
+    }
+
+    if (mainWindow) {
+        mainWindow->setUpdatesEnabled(true);
+    }
+
+    // Keep an open dialog in sync so its next Apply does not undo the batch
+    if (configChanged && customWindowDocksUI) {
+        if (QTableWidget *tableWidget = customWindowDocksUI->findChild<QTableWidget*>()) {
+            refreshDockTable(tableWidget);
+        }
+    }
+
+    QJsonObject result;
+    result["applied"] = operations.size() - errors.size();
+    result["errors"] = errors;
+    if (configChanged) {
+        result["stats"] = lastApplyStats;
+    }
+    return result;
 }
\ No newline at end of file
@@ -35,26 +35,97 @@
 #include <QSet>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
+#include <QThread>
+#include <QSemaphore>
+#include <QStackedLayout>
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QCompleter>
+#include <QListView>
+#include <QPointer>
+#include <QElapsedTimer>
 
 #include <vector>
 #include <string>
 #include <utility>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cmath>
+
+#include "window-registry.hpp"
+#include "app-icon-cache.hpp"
+#include "trace-recorder.hpp"
+#include "window-fingerprint.hpp"
+#include "native-calls.hpp"
+#include "dock-config.hpp"
+#include "dock-log.hpp"
+#include "frame-impact.hpp"
+#include "window-ownership.hpp"
+#include "timer-wheel.hpp"
+#include "window-list-model.hpp"
+#include "metrics-publisher.hpp"
+#include "focus-router.hpp"
+#include "window-watcher.hpp"
+#include "search-schedule.hpp"
 
 #pragma comment(lib, "Shcore.lib")
 
 
 constexpr const char* PLUGIN_PREFIX = "window_dock_";
 constexpr const char* CONFIG_FILE = "config.json";
+constexpr const char* HOTKEYS_FILE = "hotkeys.json";
+constexpr const char* SETTINGS_FILE = "settings.json";
+constexpr const char* DOCK_SETS_DIR = "dock-sets";
+
+// On exit every docked app gets this long to answer a probe, and the whole release this long overall
+constexpr int SHUTDOWN_PROBE_TIMEOUT_MS = 250;
+constexpr qint64 SHUTDOWN_RELEASE_DEADLINE_MS = 1000;
+constexpr int SHUTDOWN_REPARENT_JOIN_MS = 1000; // At unload, before the reparent of hung windows is given up on
+constexpr int METRICS_PUBLISH_INTERVAL_MS = 1000;
+constexpr int PROC_UI_THREAD_TIMEOUT_MS = 2000; // How long a proc call waits for the UI thread to pick up its task
+constexpr qint64 PROC_SNAPSHOT_MAX_AGE_MS = 500; // An older snapshot is still served, but asks for a fresh one
+
+
+// Style and placement of a desktop window before it was embedded, so it can be handed back exactly as it was
+struct NativeWindowState {
+    LONG_PTR style = 0;
+    LONG_PTR exStyle = 0;
+    RECT rect = {};
+    bool valid = false;
+
+    static NativeWindowState capture(HWND hwnd) {
+        NativeWindowState state;
+        state.style = GetWindowLongPtr(hwnd, GWL_STYLE);
+        state.exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+        state.valid = GetWindowRect(hwnd, &state.rect) != FALSE;
+        return state;
+    }
+};
+
+
+// What a single window dock is showing. Every state but Embedded shows the placeholder, with a message
+// matching the state.
+enum class DockState {
+    Searching,  // The window has not been found (yet)
+    Embedded,   // The window is embedded in the dock
+    Detached,   // The window was popped out and is still bound to the dock
+    Lost,       // The bound window was closed
+    Degraded    // The window was found but could not be embedded (e.g. it runs elevated)
+};
 
 
 class EmbeddedWindowWidget : public QWidget {
     Q_OBJECT
 
 public:
+    // The native window is only created once the dock is first shown (see showEvent), so docks that
+    // stay closed or tabbed away cost no native window at all
     explicit EmbeddedWindowWidget(QWidget *parent = nullptr)
         : QWidget(parent), embeddedHwnd(nullptr) {
         setContentsMargins(0, 0, 0, 0);
-        setAttribute(Qt::WA_NativeWindow, true);
         setAttribute(Qt::WA_DontCreateNativeAncestors, true);
         setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding); // Allow resizing
     }
@@ -72,18 +143,102 @@ public:
         return embeddedHwnd;
     }
 
-    void setEmbeddedHwnd(HWND hwnd) {
+    bool isMaterialized() const {
+        return materialized;
+    }
+
+    const NativeWindowState& getOriginalState() const {
+        return originalState;
+    }
+
+    // A popped out window is back on the desktop but still bound to the dock, ready to be re-embedded
+    bool isPoppedOut() const {
+        return state == DockState::Detached && embeddedHwnd != nullptr;
+    }
+
+    void setPoppedOut(bool value) {
+        hasCommittedGeometry = false;
+        setState(value ? DockState::Detached : DockState::Embedded);
+    }
+
+    DockState getState() const {
+        return state;
+    }
+
+    quint64 getResizeCount() const {
+        return resizeCount;
+    }
+
+    // Switching states only flips the visible page and the placeholder message, nothing is rebuilt
+    void setState(DockState newState) {
+        state = newState;
+        if (!stack) {
+            return;
+        }
+
+        stack->setCurrentIndex(state == DockState::Embedded ? 1 : 0);
+        if (statusLabel) {
+            statusLabel->setText(obs_module_text(stateMessageKey(state)));
+        }
+    }
+
+    // The placeholder is built once per dock and kept for the lifetime of the dock, next to an empty
+    // page that is shown while a window is embedded on top of this widget
+    void setPlaceholder(QWidget *placeholder, QLabel *messageLabel) {
+        if (stack) {
+            return;
+        }
+
+        stack = new QStackedLayout(this);
+        stack->setContentsMargins(0, 0, 0, 0);
+        stack->addWidget(placeholder);
+        stack->addWidget(new QWidget(this));
+        statusLabel = messageLabel;
+
+        setState(state);
+    }
+
+    bool hasPlaceholder() const {
+        return stack != nullptr;
+    }
+
+    // Build the dock content the first time the dock becomes visible, or right away if it already has
+    void setFirstShowHandler(const std::function<void()> &handler) {
+        if (materialized) {
+            handler();
+            return;
+        }
+        firstShowHandler = handler;
+    }
+
+    // Returns false when the window could not be reparented, the dock is then Degraded
+    bool setEmbeddedHwnd(HWND hwnd, const NativeWindowState &windowState = NativeWindowState()) {
         embeddedHwnd = hwnd;
-        if (hwnd) {
-            SetParent(hwnd, (HWND)this->winId());
-            adjustWindowSize();
+        originalState = windowState;
+        hasCommittedGeometry = false;
+        if (!hwnd) {
+            setState(DockState::Searching);
+            return true;
         }
+
+        nativeCalls.setParent++;
+        SetParent(hwnd, (HWND)this->winId());
+
+        // Windows of more privileged processes refuse to be reparented and stay on the desktop
+        if (GetAncestor(hwnd, GA_PARENT) != (HWND)this->winId()) {
+            embeddedHwnd = nullptr;
+            setState(DockState::Degraded);
+            return false;
+        }
+
+        setState(DockState::Embedded);
+        adjustWindowSize();
+        return true;
     }
 
     void adjustWindowSize() {
-        // blog(LOG_INFO, "adjustWindowSize called");
-        if (!embeddedHwnd) {
-            // blog(LOG_WARNING, "adjustWindowSize called but embeddedHwnd is NULL.");
+        if (!embeddedHwnd || state != DockState::Embedded) {
+            DOCK_LOG(LOG_DEBUG, "adjustWindowSize skipped: hwnd=0x%llx state=%lld", embeddedHwnd, (int)state);
             return;
         }
 
@@ -115,63 +270,338 @@ public:
         int newWidth = (int)((rect.right - rect.left) * scaleX);
         int newHeight = (int)((rect.bottom - rect.top) * scaleY);
 
+        // Skip the native call when the geometry has not changed since the last commit (e.g. a hidden dock being shown again)
+        RECT newGeometry = { rect.left, rect.top, rect.left + newWidth, rect.top + newHeight };
+        if (hasCommittedGeometry && EqualRect(&newGeometry, &committedGeometry)) {
+            DOCK_LOG(LOG_DEBUG, "adjustWindowSize unchanged: hwnd=0x%llx %lldx%lld", embeddedHwnd, newWidth, newHeight);
+            return;
+        }
+
         // Set the new window size and position
+        nativeCalls.setWindowPos++;
         SetWindowPos(embeddedHwnd, NULL, rect.left, rect.top, newWidth, newHeight, SWP_NOZORDER | SWP_NOACTIVATE | SWP_FRAMECHANGED);
+        committedGeometry = newGeometry;
+        hasCommittedGeometry = true;
+        resizeCount++;
+
+        TraceRecorder::instance().recordResize(embeddedHwnd, newWidth, newHeight);
+        FrameImpactMonitor::instance().recordResize(embeddedHwnd);
+
+        DOCK_LOG(LOG_DEBUG, "Adjusted window size: hwnd=0x%llx %lldx%lld, dpi %lld -> %lld", embeddedHwnd, newWidth, newHeight,
+                 sourceDpiX, destDpiX);
+    }
+
+    // Build the dock content now rather than on the first show, e.g. for a dock a hotkey may show at any time
+    void materialize() {
+        if (materialized) {
+            return;
+        }
+
+        materialized = true;
+        setAttribute(Qt::WA_NativeWindow, true);
 
-        // blog(LOG_INFO, "Adjusted window size: new width = %d, new height = %d, scaleX = %f, scaleY = %f", newWidth, newHeight, scaleX, scaleY);
+        std::function<void()> handler = std::move(firstShowHandler);
+        firstShowHandler = nullptr;
+        if (handler) {
+            handler();
+        }
     }
 
 protected:
+    void showEvent(QShowEvent *event) override {
+        QWidget::showEvent(event);
+        materialize();
+    }
+
+    // Clicks on the embedded window reach the dock as WM_PARENTNOTIFY, before the window handles them
+    bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override {
+        MSG *msg = static_cast<MSG*>(message);
+        if (msg->message == WM_PARENTNOTIFY && state == DockState::Embedded) {
+            FocusRouter::instance().routeClick(msg->hwnd, msg->wParam, msg->lParam);
+        }
+        return QWidget::nativeEvent(eventType, message, result);
+    }
+
     void resizeEvent(QResizeEvent *event) override {
-        // blog(LOG_INFO, "resizeEvent called");
         QWidget::resizeEvent(event);
 
-        // blog(LOG_INFO, "EmbeddedWindowWidget resized: new width = %d, new height = %d", width(), height());
+        DOCK_LOG(LOG_DEBUG, "EmbeddedWindowWidget resized: %lldx%lld, hwnd=0x%llx", width(), height(), embeddedHwnd);
 
         if (embeddedHwnd) {
-            // blog(LOG_INFO, "embeddedHwnd");
-            // blog(LOG_INFO, "Widget resized: new width = %d, new height = %d", width(), height());
             adjustWindowSize(); // Adjust the window size during resize
         }
     }
 
 private:
     HWND embeddedHwnd;
+    RECT committedGeometry = {};
+    bool hasCommittedGeometry = false;
+    bool materialized = false;
+    quint64 resizeCount = 0;
+    std::function<void()> firstShowHandler;
+    NativeWindowState originalState;
+    DockState state = DockState::Searching;
+    QStackedLayout *stack = nullptr;
+    QLabel *statusLabel = nullptr;
+
+    static const char* stateMessageKey(DockState dockState) {
+        switch (dockState) {
+        case DockState::Detached:
+            return "BlankDock.Detached";
+        case DockState::Lost:
+            return "BlankDock.Lost";
+        case DockState::Degraded:
+            return "BlankDock.Degraded";
+        default:
+            return "BlankDock.Description";
+        }
+    }
 };
 
 
-struct DockEntry {
-    QString oldDesktopWindow;
-    QString oldDesktopWindowWithProgramName;
-    QString oldDockId;
-    QString oldDockName;
-    QString newDesktopWindow;
-    QString newDesktopWindowWithProgramName;
-    QString newDockId;
-    QString newDockName;
+// Dock hosting several desktop windows, laid out together in a grid or a horizontal/vertical split
+class TiledWindowWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    struct Tile {
+        QString windowTitle;
+        HWND hwnd = nullptr;
+        NativeWindowState originalState;
+        RECT committedGeometry = {};
+        bool hasCommittedGeometry = false;
+    };
+
+    explicit TiledWindowWidget(const QStringList &windowTitles, const QString &layoutMode, QWidget *parent = nullptr)
+        : QWidget(parent), layoutMode(layoutMode) {
+        setContentsMargins(0, 0, 0, 0);
+        setAttribute(Qt::WA_NativeWindow, true);
+        setAttribute(Qt::WA_DontCreateNativeAncestors, true);
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding); // Allow resizing
+
+        for (const QString &windowTitle : windowTitles) {
+            Tile tile;
+            tile.windowTitle = windowTitle;
+            tiles.push_back(tile);
+        }
+    }
+
+    const std::vector<Tile>& getTiles() const {
+        return tiles;
+    }
+
+    // Tiles whose window is not embedded (any more), the dock matches and claims them in one enumeration
+    int missingTileCount() const {
+        int missingCount = 0;
+        for (const Tile &tile : tiles) {
+            if (!tile.hwnd || !IsWindow(tile.hwnd)) {
+                missingCount++;
+            }
+        }
+        return missingCount;
+    }
+
+    // Embed a window the dock has claimed for this tile, the caller lays the tiles out once all are attached
+    void attachTile(size_t index, HWND hwnd, const NativeWindowState &windowState) {
+        Tile &tile = tiles[index];
+        tile.hwnd = hwnd;
+        tile.originalState = windowState;
+        tile.hasCommittedGeometry = false;
+
+        // Ensure the embedded window does not have any toolbars or borders, and behaves as a child window
+        LONG_PTR style = GetWindowLongPtr(hwnd, GWL_STYLE);
+        style &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZE | WS_MAXIMIZE | WS_SYSMENU | WS_POPUP);
+        style |= WS_CHILD;
+        nativeCalls.setWindowLong++;
+        SetWindowLongPtr(hwnd, GWL_STYLE, style);
+
+        nativeCalls.setParent++;
+        SetParent(hwnd, (HWND)this->winId());
+        ShowWindow(hwnd, SW_SHOWNA);
+    }
+
+    const Tile* tileOf(HWND hwnd) const {
+        for (const Tile &tile : tiles) {
+            if (hwnd && tile.hwnd == hwnd) {
+                return &tile;
+            }
+        }
+        return nullptr;
+    }
+
+    // Forget the tile of a window that was destroyed, without touching the stale handle again
+    bool dropTile(HWND hwnd) {
+        for (Tile &tile : tiles) {
+            if (tile.hwnd == hwnd) {
+                tile.hwnd = nullptr;
+                tile.originalState = NativeWindowState();
+                tile.hasCommittedGeometry = false;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isMissingTile(const QString &windowTitle) const {
+        for (const Tile &tile : tiles) {
+            if (!tile.hwnd && tile.windowTitle == windowTitle) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Detach every tile from the widget without touching the windows, once they have been released
+    void clearTiles() {
+        for (Tile &tile : tiles) {
+            tile.hwnd = nullptr;
+            tile.originalState = NativeWindowState();
+            tile.hasCommittedGeometry = false;
+        }
+    }
+
+    void layoutTiles() {
+        int tileCount = (int)tiles.size();
+        if (tileCount == 0) {
+            return;
+        }
+
+        int columns = tileCount;
+        if (layoutMode == "vertical") {
+            columns = 1;
+        } else if (layoutMode != "horizontal") {
+            columns = (int)std::ceil(std::sqrt((double)tileCount));
+        }
+        int rows = (tileCount + columns - 1) / columns;
+
+        // Get the DPI of the destination window (OBS dock), shared by every tile
+        HWND containerHwnd = (HWND)this->winId();
+        HMONITOR hDestMonitor = MonitorFromWindow(containerHwnd, MONITOR_DEFAULTTONEAREST);
+        UINT destDpiX, destDpiY;
+        if (GetDpiForMonitor(hDestMonitor, MDT_EFFECTIVE_DPI, &destDpiX, &destDpiY) != S_OK) {
+            destDpiX = 96; // Default to 96 DPI if unable to retrieve
+            destDpiY = 96;
+        }
+
+        RECT rect;
+        GetClientRect(containerHwnd, &rect);
+        int width = rect.right - rect.left;
+        int height = rect.bottom - rect.top;
+
+        // Compute every tile rectangle in one pass, then commit them all as one batched geometry update
+        HDWP deferredPositions = BeginDeferWindowPos(tileCount);
+
+        for (int i = 0; i < tileCount && deferredPositions; ++i) {
+            Tile &tile = tiles[i];
+            if (!tile.hwnd) {
+                continue;
+            }
+
+            int column = i % columns;
+            int row = i / columns;
+            int left = rect.left + width * column / columns;
+            int top = rect.top + height * row / rows;
+            int cellWidth = rect.left + width * (column + 1) / columns - left;
+            int cellHeight = rect.top + height * (row + 1) / rows - top;
+
+            // Get the DPI of the source window
+            HMONITOR hMonitor = MonitorFromWindow(tile.hwnd, MONITOR_DEFAULTTONEAREST);
+            UINT sourceDpiX, sourceDpiY;
+            if (GetDpiForMonitor(hMonitor, MDT_EFFECTIVE_DPI, &sourceDpiX, &sourceDpiY) != S_OK) {
+                sourceDpiX = 96; // Default to 96 DPI if unable to retrieve
+                sourceDpiY = 96;
+            }
+
+            int tileWidth = (int)(cellWidth * ((float)destDpiX / (float)sourceDpiX));
+            int tileHeight = (int)(cellHeight * ((float)destDpiY / (float)sourceDpiY));
+
+            RECT tileGeometry = { left, top, left + tileWidth, top + tileHeight };
+            if (tile.hasCommittedGeometry && EqualRect(&tileGeometry, &tile.committedGeometry)) {
+                continue;
+            }
+
+            nativeCalls.setWindowPos++;
+            deferredPositions = DeferWindowPos(deferredPositions, tile.hwnd, NULL, left, top, tileWidth, tileHeight,
+                                               SWP_NOZORDER | SWP_NOACTIVATE | SWP_FRAMECHANGED);
+            tile.committedGeometry = tileGeometry;
+            tile.hasCommittedGeometry = true;
+        }
 
-    bool isNew() const {
-        return oldDockId.isEmpty();
+        if (!deferredPositions || !EndDeferWindowPos(deferredPositions)) {
+            // The batch was dropped, so make sure the next pass commits every tile again
+            for (Tile &tile : tiles) {
+                tile.hasCommittedGeometry = false;
+            }
+        }
     }
 
-    bool isModified() const {
-        return oldDesktopWindow != newDesktopWindow ||
-            oldDesktopWindowWithProgramName != newDesktopWindowWithProgramName ||
-            oldDockId != newDockId ||
-            oldDockName != newDockName;
+protected:
+    void resizeEvent(QResizeEvent *event) override {
+        QWidget::resizeEvent(event);
+        layoutTiles();
     }
 
-    bool isUnchanged() const {
-        return oldDesktopWindow == newDesktopWindow &&
-            oldDesktopWindowWithProgramName == newDesktopWindowWithProgramName &&
-            oldDockId == newDockId &&
-            oldDockName == newDockName;
+    bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override {
+        MSG *msg = static_cast<MSG*>(message);
+        if (msg->message == WM_PARENTNOTIFY) {
+            FocusRouter::instance().routeClick(msg->hwnd, msg->wParam, msg->lParam);
+        }
+        return QWidget::nativeEvent(eventType, message, result);
     }
+
+private:
+    std::vector<Tile> tiles;
+    QString layoutMode;
+};
+
+
+// One step of an Apply. Renames and retargets are carried out on the live dock, only a new dock ID
+// or a new tile set needs the dock to be removed and created again.
+enum class DockOperationType {
+    Create,
+    Rename,
+    Retarget,
+    Remove,
+    Unchanged
+};
+
+struct DockOperation {
+    DockOperationType type;
+    QString dockId;
+    int entryIndex;
+};
+
+
+// What the list of docks follows. With a dock set per scene collection or profile, each one has its
+// own config file under DOCK_SETS_DIR and the docks switch along with it.
+enum class DockSetMode {
+    Global,
+    SceneCollection,
+    Profile
+};
+
+
+// Attach history of a dock, published in the metrics segment
+struct DockMetrics {
+    quint64 attaches = 0;
+    quint32 lastAttachUs = 0;
+};
+
+
+class WindowDockUI;
+
+// Per-dock frontend hotkey, handed to OBS as the callback data
+struct DockHotkey {
+    WindowDockUI *windowDockUI;
+    QString dockId;
+    bool focus;
+    obs_hotkey_id id;
 };
 
 
 class WindowDockUI : public QWidget {
     Q_OBJECT
+    friend class StressHarness;
 
 public:
     explicit WindowDockUI(QWidget *parent = nullptr);
@@ -182,32 +612,155 @@ public:
     void releaseEmbeddedWindow(EmbeddedWindowWidget *dockWidget);
     void releaseEmbeddedWindowByDockId(const QString &dockId);
     void freeEmbeddedWindowsOnClose();
+    void releaseWindowsOnExit();
+    void joinReleaseThread();
     void clearLayout(QLayout *layout);
     void restoreDocksOnStartup();
+    void finishStartup();
     void applyChanges();
 
+    void toggleDock(const QString &dockId);
+    void focusDock(const QString &dockId);
+    void saveHotkeyBindings();
+    void releaseDockHotkeys();
+
+    void registerProcHandlers();
+    void onFrontendEvent(enum obs_frontend_event event);
+    QJsonObject applyDockOperations(const QJsonArray &operations);
+
 private:
     void addNewRow(QTableWidget *tableWidget);
-    void populateDesktopWindowsComboBox(QComboBox* comboBox);
+    QComboBox* createWindowPicker();
     void addDetachButtonsToTable(QTableWidget *tableWidget);
     void addTrashButtonsToTable(QTableWidget *tableWidget);
+    void openFrameImpactReport(QWidget *parent);
+    void fillFrameImpactTable(QTableWidget *tableWidget);
     
+    QList<DockEntry> readDockEntries();
     void loadDockEntries(QTableWidget *tableWidget);
+    void refreshDockTable(QTableWidget *tableWidget);
     void saveDockEntries(const QList<DockEntry> &dockEntries);
+    void applyDockEntries(const QList<DockEntry> &entries);
+    QList<DockOperation> planDockOperations(const QList<DockEntry> &entries, const QSet<QString> &configuredDockIds) const;
+    static QString makeDockId(const QString &dockName, const QList<DockEntry> &entries);
+
+    // A dock that is only rebuilt keeps its hotkey bindings and the fingerprint of its window
+    void removeDock(const QString &dockId, bool keepBindings);
+    void renameDock(const QString &dockId, const QString &dockName);
+    void retargetDock(const QString &dockId, const QString &windowTitle);
 
     QString extractWindowTitle(const QString &fullName);
-    QJsonObject getDockConfigById(const QString &dockId);
     void attemptWindowCapture(const QString &dockId, const QString &windowTitle);
 
-    EmbeddedWindowWidget* createBlankDockContent(const QString &dockId, const QString &windowTitle);
+    void installPlaceholder(EmbeddedWindowWidget *dockWidget, const QString &dockId);
     EmbeddedWindowWidget* createDockContent(const QString &dockId, const QString &dockName, const QString &windowTitle);
 
     void createOrUpdateDock(const QString &dockId, const QString &dockName, const QString &windowTitle);
+    void createOrUpdateTiledDock(const QString &dockId, const QString &dockName, const QJsonArray &tiles, const QString &layoutMode);
+    void releaseTiledWindows(TiledWindowWidget *tiledWidget);
+    static void restoreDesktopWindow(HWND hwnd, const NativeWindowState &state = NativeWindowState(), bool async = false);
+    static void postDesktopWindowRestore(HWND hwnd, const NativeWindowState &state);
+    bool reembedWindow(const QString &dockId);
     void updateDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle);
-    void initiateDockCreationOnStartup(const QString &dockId, const QString &dockName, const QString &windowTitle);
+    bool embedWindow(EmbeddedWindowWidget *dockWidget, const QString &dockId, HWND hwnd, const QString &windowTitle); // False when the window stays on the desktop
+    void initiateDockCreationOnStartup(const QString &dockId, const QString &dockName, const QString &windowTitle, HWND matchedHwnd = nullptr);
+    void deferDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, HWND matchedHwnd, bool keepSearching);
+    void materializeDockContent(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, HWND matchedHwnd, bool keepSearching);
+    void startWindowSearch(EmbeddedWindowWidget *dockWidget, const QString &dockId, const QString &windowTitle, int attempt = 0);
+    void startTileSearch(TiledWindowWidget *tiledWidget, int attempt = 0);
+    int captureMissingTiles(TiledWindowWidget *tiledWidget);
+    void matchStartupWindows();
+    void onWindowDestroyed(HWND hwnd);
+    void onWindowAppeared(HWND hwnd);
+    void rematchLostWindows();
+
+    HWND resolveDockWindow(const QString &dockId, const QString &windowTitle);
+    bool claimWindow(HWND hwnd, const QString &dockId, NativeWindowState *originalState = nullptr);
+    void scheduleFingerprintSave();
+    void saveFingerprints();
+    void scheduleMetricsPublish();
+    void publishMetrics();
+
+    QString getConfigDirPath() const;
+    QString getConfigFilePath() const;
+    QString currentDockSetName() const;
+    QString dockSetFileName(const QString &setName) const;
+    void activateDockSet(const QString &fileName);
+    void switchDockSet();
+    void loadSettings();
+    QDockWidget* getDockFrame(const QString &dockId);
+
+    void registerDockHotkeys(const QString &dockId, const QString &dockName);
+    void unregisterDockHotkeys(const QString &dockId);
+    const QJsonObject& getHotkeyBindings();
+    bool hasHotkeyBinding(const QString &dockId);
+    void captureHotkeyBindings(const QString &dockId);
+    static void onDockHotkey(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey, bool pressed);
+
+    // What the read-only procs serve, published by the UI thread so their callers never wait for it
+    struct ProcSnapshot {
+        QByteArray windows = "[]";
+        QByteArray docks = "[]";
+        QByteArray stats = "{}";
+        QElapsedTimer published;
+    };
+
+    bool runOnUiThread(const std::function<void()> &task, int timeoutMs = PROC_UI_THREAD_TIMEOUT_MS);
+    void publishProcSnapshot();
+    ProcSnapshot readProcSnapshot();
+    static void procListWindows(void *data, calldata_t *cd);
+    static void procListDocks(void *data, calldata_t *cd);
+    static void procApply(void *data, calldata_t *cd);
+    static void procTraceStart(void *data, calldata_t *cd);
+    static void procTraceStop(void *data, calldata_t *cd);
+    static void procFlushLog(void *data, calldata_t *cd);
+    static void procStats(void *data, calldata_t *cd);
+#ifdef ENABLE_STRESS_HARNESS
+    static void procStress(void *data, calldata_t *cd);
+#endif
 
     QWidget *customWindowDocksUI = nullptr;
     QMap<QString, EmbeddedWindowWidget*> activeDocks;
-    std::vector<std::pair<QString, HWND>> getDesktopWindows();
+    QMap<QString, TiledWindowWidget*> tiledDocks;
+    QMap<QString, WindowFingerprint> dockFingerprints;
+    QHash<QString, QString> dockWindowTitles; // Dock ID to the title of the window it docks
+    DockIdPool dockIds;
+    WindowOwnership windowOwnership;
+    QHash<QString, int> dockOrdinals; // Position of each dock in the config, earlier docks win ownership conflicts
+    QJsonObject lastApplyStats;
+    std::mutex procSnapshotMutex;
+    ProcSnapshot procSnapshot;
+    std::atomic<bool> procSnapshotRequested = false;
+    std::atomic<int> applyRequests = 0;
+    int materializedDockCount = 0;
+    bool fingerprintSavePending = false;
+    TimerWheel timerWheel;
+    QHash<QString, TimerId> windowSearches;
+    QElapsedTimer startupClock;
+    QList<QPair<QString, QString>> startupDocks; // Dock ID and window title, matched together on the first show
+    QHash<QString, HWND> startupMatches;
+    QList<QPointer<TiledWindowWidget>> startupTiledDocks;
+    QHash<QString, QString> lostDocks; // Dock ID to window title, for docks whose window was closed
+    QList<QPointer<TiledWindowWidget>> lostTiledDocks;
+    QTimer rematchTimer;
+    QElapsedTimer rematchClock; // Since the first sign of a lost window coming back
+    bool startupMatching = false; // Until OBS has finished loading
+    DockSetMode dockSetMode = DockSetMode::Global;
+    QString configFileName = CONFIG_FILE; // Relative to the config directory, follows the active dock set
+    MetricsPublisher metricsPublisher;
+    bool metricsEnabled = false;
+    QHash<QString, DockMetrics> dockMetrics;
+    quint64 hungWindowCount = 0;
+    std::thread releaseThread; // Reparents the windows found hung on exit
+    NativeCallCounters publishedCalls; // Totals at the previous publish, for the rates
+    uint64_t publishedTimeNs = 0;
+    void onAppIconReady(const QString &executablePath);
+
+    WindowRegistry windowRegistry;
+    AppIconCache appIconCache;
+    QPointer<WindowListModel> windowListModel; // Shared by the picker rows, lives as long as the dialog
     QList<DockEntry> dockEntries;
+    QMap<QString, QList<DockHotkey*>> dockHotkeys;
+    QJsonObject hotkeyBindings;
+    bool hotkeyBindingsLoaded = false;
 };
\ No newline at end of file
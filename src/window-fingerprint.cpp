@@ -0,0 +1,156 @@
+#include "window-fingerprint.hpp"
+
+#include <QJsonArray>
+#include <QRegularExpression>
+
+
+// Match scores, an exact title alone is enough to match (the behaviour before fingerprints existed)
+constexpr int SCORE_EXACT_TITLE = 50;
+constexpr int SCORE_TITLE_PATTERN = 25;
+constexpr int SCORE_EXECUTABLE = 25;
+constexpr int SCORE_WINDOW_CLASS = 15;
+constexpr int SCORE_ORDINAL = 5;
+constexpr int SCORE_REQUIRED = 50;
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*------------------------------------SERIALIZATION------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+QJsonObject WindowFingerprint::toJson() const {
+    QJsonObject fingerprintObject;
+    fingerprintObject["executablePath"] = executablePath;
+    fingerprintObject["windowClass"] = windowClass;
+    fingerprintObject["titlePattern"] = titlePattern;
+    fingerprintObject["geometry"] = QJsonArray{geometry.x(), geometry.y(), geometry.width(), geometry.height()};
+    fingerprintObject["ordinal"] = ordinal;
+    return fingerprintObject;
+}
+
+WindowFingerprint WindowFingerprint::fromJson(const QJsonObject &fingerprintObject) {
+    WindowFingerprint fingerprint;
+    fingerprint.executablePath = fingerprintObject["executablePath"].toString();
+    fingerprint.windowClass = fingerprintObject["windowClass"].toString();
+    fingerprint.titlePattern = fingerprintObject["titlePattern"].toString();
+    fingerprint.ordinal = fingerprintObject["ordinal"].toInt(-1);
+
+    QJsonArray geometry = fingerprintObject["geometry"].toArray();
+    if (geometry.size() == 4) {
+        fingerprint.geometry = QRect(geometry[0].toInt(), geometry[1].toInt(), geometry[2].toInt(), geometry[3].toInt());
+    }
+
+    return fingerprint;
+}
+
+QString WindowFingerprint::titlePatternFor(const QString &windowTitle) {
+    // Escape the wildcard characters of the title itself, then let any run of digits vary
+    QString pattern = windowTitle;
+    pattern.replace("[", "[[]").replace("?", "[?]").replace("*", "[*]");
+    pattern.replace(QRegularExpression("\\d+"), "*");
+    return pattern;
+}
+
+WindowFingerprint WindowFingerprint::capture(HWND hwnd, const WindowRegistry &windowRegistry) {
+    WindowFingerprint fingerprint;
+
+    const WindowInfo *window = windowRegistry.findByHwnd(hwnd);
+    if (window) {
+        fingerprint.executablePath = window->executablePath;
+        fingerprint.windowClass = window->className;
+        fingerprint.titlePattern = titlePatternFor(window->title);
+
+        // Position among the windows of the same executable and class, in enumeration order
+        int ordinal = 0;
+        for (const WindowInfo &other : windowRegistry.windows()) {
+            if (other.hwnd == hwnd) {
+                fingerprint.ordinal = ordinal;
+                break;
+            }
+            if (other.executablePath == window->executablePath && other.className == window->className) {
+                ordinal++;
+            }
+        }
+    } else {
+        // Not in the last enumeration, the window is queried on its own. Its ordinal would take a whole
+        // enumeration, the executable, class and title match it well enough.
+        WindowInfo windowInfo = WindowRegistry::describe(hwnd);
+        fingerprint.executablePath = windowInfo.executablePath;
+        fingerprint.windowClass = windowInfo.className;
+        if (!windowInfo.title.isEmpty()) {
+            fingerprint.titlePattern = titlePatternFor(windowInfo.title);
+        }
+    }
+
+    RECT rect;
+    if (GetWindowRect(hwnd, &rect)) {
+        fingerprint.geometry = QRect(rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+    }
+
+    return fingerprint;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------MATCHING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+const WindowInfo* matchWindow(const std::vector<WindowInfo> &windows, const QString &windowTitle, const WindowFingerprint &fingerprint,
+                              const QSet<HWND> &takenWindows) {
+    QRegularExpression titleExpression;
+    if (!fingerprint.titlePattern.isEmpty()) {
+        titleExpression = QRegularExpression::fromWildcard(fingerprint.titlePattern, Qt::CaseInsensitive);
+    }
+
+    const WindowInfo *bestWindow = nullptr;
+    int bestScore = 0;
+    int ordinal = 0;
+
+    for (const WindowInfo &window : windows) {
+        int score = 0;
+
+        if (window.title == windowTitle) {
+            score += SCORE_EXACT_TITLE;
+        } else if (titleExpression.isValid() && !fingerprint.titlePattern.isEmpty() && titleExpression.match(window.title).hasMatch()) {
+            score += SCORE_TITLE_PATTERN;
+        }
+
+        bool sameExecutable = !fingerprint.executablePath.isEmpty() &&
+            window.executablePath.compare(fingerprint.executablePath, Qt::CaseInsensitive) == 0;
+        bool sameClass = !fingerprint.windowClass.isEmpty() && window.className == fingerprint.windowClass;
+
+        if (sameExecutable) {
+            score += SCORE_EXECUTABLE;
+        }
+        if (sameClass) {
+            score += SCORE_WINDOW_CLASS;
+        }
+        if (sameExecutable && sameClass) {
+            if (ordinal == fingerprint.ordinal) {
+                score += SCORE_ORDINAL;
+            }
+            ordinal++;
+        }
+
+        // Still counted for the ordinal above, so the remaining instances keep their positions
+        if (takenWindows.contains(window.hwnd)) {
+            continue;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestWindow = &window;
+        }
+    }
+
+    return bestScore >= SCORE_REQUIRED ? bestWindow : nullptr;
+}
\ No newline at end of file
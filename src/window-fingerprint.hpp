@@ -0,0 +1,39 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QJsonObject>
+#include <QRect>
+#include <QSet>
+#include <QString>
+
+#include <vector>
+
+#include "window-registry.hpp"
+
+
+// What the plugin remembers about a docked window, so it can be found again after a restart even when
+// its title has changed slightly (e.g. a viewer count in a chat window title)
+struct WindowFingerprint {
+    QString executablePath;
+    QString windowClass;
+    QString titlePattern;
+    QRect geometry;
+    int ordinal = -1;
+
+    bool isEmpty() const {
+        return executablePath.isEmpty() && windowClass.isEmpty() && titlePattern.isEmpty();
+    }
+
+    QJsonObject toJson() const;
+    static WindowFingerprint fromJson(const QJsonObject &fingerprintObject);
+
+    static WindowFingerprint capture(HWND hwnd, const WindowRegistry &windowRegistry);
+    static QString titlePatternFor(const QString &windowTitle);
+};
+
+
+// Picks the best candidate for a dock out of one enumeration, or nullptr if nothing scores high enough.
+// Windows in takenWindows already belong to another dock and are passed over.
+const WindowInfo* matchWindow(const std::vector<WindowInfo> &windows, const QString &windowTitle, const WindowFingerprint &fingerprint,
+                              const QSet<HWND> &takenWindows = QSet<HWND>());
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "window-list-model.hpp"
+
+#include "dock-log.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QHash>
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*--------------------------------------WINDOW LIST------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+WindowListModel::WindowListModel(AppIconCache &appIconCache, int iconPixelSize, QObject *parent)
+    : QAbstractListModel(parent), appIconCache(appIconCache), iconPixelSize(iconPixelSize) {
+}
+
+void WindowListModel::update(const std::vector<WindowInfo> &windows) {
+    emit aboutToUpdate();
+
+    QHash<HWND, const WindowInfo*> current;
+    current.reserve((int)windows.size());
+    for (const WindowInfo &window : windows) {
+        current.insert(window.hwnd, &window);
+    }
+
+    // A retitled window keeps its row, only windows that are gone lose theirs
+    std::vector<bool> gone(rows.size(), false);
+    for (int i = 0; i < (int)rows.size(); ++i) {
+        auto windowIter = current.find(rows[i].window.hwnd);
+        if (windowIter == current.end()) {
+            gone[i] = true;
+            continue;
+        }
+
+        const WindowInfo &window = *windowIter.value();
+        if (window.title != rows[i].window.title || window.executable != rows[i].window.executable) {
+            rows[i] = {window, (window.executable + QLatin1Char(' ') + window.title).toLower()};
+            QModelIndex changed = index(i + 1);
+            emit dataChanged(changed, changed, {Qt::DisplayRole, Qt::EditRole});
+        }
+        current.erase(windowIter);
+    }
+
+    // Back to front, one removal for each run of rows that are gone
+    for (int last = (int)rows.size() - 1; last >= 0; --last) {
+        if (!gone[last]) {
+            continue;
+        }
+
+        int first = last;
+        while (first > 0 && gone[first - 1]) {
+            first--;
+        }
+
+        beginRemoveRows(QModelIndex(), first + 1, last + 1);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    std::vector<Row> added;
+    for (const WindowInfo &window : windows) {
+        if (current.contains(window.hwnd)) {
+            added.push_back({window, (window.executable + QLatin1Char(' ') + window.title).toLower()});
+        }
+    }
+
+    if (!added.empty()) {
+        int first = (int)rows.size() + 1;
+        beginInsertRows(QModelIndex(), first, first + (int)added.size() - 1);
+        rows.insert(rows.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+        endInsertRows();
+    }
+
+    lastUpdate.start();
+    emit updated();
+}
+
+int WindowListModel::rowOf(HWND hwnd) const {
+    for (int i = 0; i < (int)rows.size(); ++i) {
+        if (rows[i].window.hwnd == hwnd) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void WindowListModel::iconReady(const QString &executablePath) {
+    for (int i = 0; i < (int)rows.size(); ++i) {
+        if (rows[i].window.executablePath == executablePath) {
+            QModelIndex changed = index(i + 1);
+            emit dataChanged(changed, changed, {Qt::DecorationRole});
+        }
+    }
+}
+
+int WindowListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : (int)rows.size() + 1;
+}
+
+QVariant WindowListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() > (int)rows.size()) {
+        return QVariant();
+    }
+
+    if (index.row() == 0) {
+        return role == Qt::DisplayRole ? QVariant(QString(obs_module_text("DockManagement.DesktopWindowComboBoxPlaceholder"))) : QVariant();
+    }
+
+    const WindowInfo &window = rows[index.row() - 1].window;
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return window.label();
+    case Qt::DecorationRole:
+        // Only rows the popup actually paints ask for their icon
+        return appIconCache.icon(window.executablePath, iconPixelSize);
+    case Qt::UserRole:
+        return QVariant::fromValue(window.hwnd);
+    default:
+        return QVariant();
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*----------------------------------------FILTER---------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+WindowFilterModel::WindowFilterModel(WindowListModel *sourceModel, QObject *parent)
+    : QAbstractListModel(parent), sourceModel(sourceModel) {
+    // Rows come and go when the shared list is updated for another picker row. The filter starts again
+    // once the whole update is done, retitled rows may match differently.
+    auto sourceRowsChanged = [this]() {
+        beginResetModel();
+        rebuild(false);
+        endResetModel();
+    };
+    connect(sourceModel, &WindowListModel::updated, this, sourceRowsChanged);
+    connect(sourceModel, &QAbstractItemModel::modelReset, this, sourceRowsChanged);
+    connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+        if (!visibleRows.empty()) {
+            emit dataChanged(index(0), index((int)visibleRows.size() - 1), roles);
+        }
+    });
+
+    rebuild(false);
+}
+
+void WindowFilterModel::setFilterText(const QString &text) {
+    QString needle = text.trimmed().toLower();
+    if (needle == filterText) {
+        return;
+    }
+
+    bool narrowing = !filterText.isEmpty() && needle.startsWith(filterText);
+    filterText = needle;
+
+    beginResetModel();
+    rebuild(narrowing);
+    endResetModel();
+}
+
+void WindowFilterModel::rebuild(bool narrowing) {
+    uint64_t filterStart = os_gettime_ns();
+    std::vector<int> candidates;
+
+    if (narrowing) {
+        candidates.swap(visibleRows);
+    } else {
+        int sourceRows = sourceModel->rowCount();
+        candidates.reserve(sourceRows);
+        for (int row = 1; row < sourceRows; ++row) {
+            candidates.push_back(row);
+        }
+    }
+
+    visibleRows.clear();
+    for (int row : candidates) {
+        if (filterText.isEmpty() || matches(sourceModel->filterKey(row), filterText)) {
+            visibleRows.push_back(row);
+        }
+    }
+
+    DOCK_LOG(LOG_DEBUG, "Window filter: %lld of %lld rows in %lld us", (int)visibleRows.size(), (int)candidates.size(),
+             (os_gettime_ns() - filterStart) / 1000);
+}
+
+bool WindowFilterModel::matches(const QString &filterKey, const QString &needle) {
+    if (filterKey.contains(needle)) {
+        return true;
+    }
+
+    // Fuzzy fallback: the typed characters in order, with anything in between (e.g. "chrtw" for "chrome ... twitch")
+    int position = 0;
+    for (QChar character : needle) {
+        if (character == QLatin1Char(' ')) {
+            continue;
+        }
+        position = filterKey.indexOf(character, position);
+        if (position < 0) {
+            return false;
+        }
+        position++;
+    }
+    return true;
+}
+
+int WindowFilterModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : (int)visibleRows.size();
+}
+
+QVariant WindowFilterModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= (int)visibleRows.size()) {
+        return QVariant();
+    }
+    return sourceModel->data(sourceModel->index(visibleRows[index.row()]), role);
+}
\ No newline at end of file
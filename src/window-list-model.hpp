@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QString>
+
+#include <vector>
+
+#include "app-icon-cache.hpp"
+#include "window-registry.hpp"
+
+
+constexpr int WINDOW_LIST_MAX_AGE_MS = 2000; // An older snapshot is brought up to date before a new picker row uses it
+
+
+// The desktop windows for the picker, one snapshot shared by every row of the dialog. Row 0 is the
+// "Select a window..." placeholder so combo box indexes keep their meaning.
+class WindowListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    WindowListModel(AppIconCache &appIconCache, int iconPixelSize, QObject *parent = nullptr);
+
+    // Retitles windows in place, removes the ones that are gone and appends new ones. Rows that stay
+    // keep their place, so a picker can find its window again by HWND.
+    void update(const std::vector<WindowInfo> &windows);
+
+    int rowOf(HWND hwnd) const; // 0 when the window is not listed
+
+    bool isStale() const {
+        return !lastUpdate.isValid() || lastUpdate.elapsed() > WINDOW_LIST_MAX_AGE_MS;
+    }
+
+    void iconReady(const QString &executablePath);
+
+    // Lower case "executable title", what the filter matches against
+    const QString &filterKey(int row) const {
+        return rows[row - 1].filterKey;
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+signals:
+    // Around the row changes of one update, so views can hold on to their selection and filters
+    // rebuild once instead of for every removed run
+    void aboutToUpdate();
+    void updated();
+
+private:
+    struct Row {
+        WindowInfo window;
+        QString filterKey;
+    };
+
+    AppIconCache &appIconCache;
+    int iconPixelSize;
+    std::vector<Row> rows;
+    QElapsedTimer lastUpdate;
+};
+
+
+// Type-to-filter view of the shared window list for one picker row. Typing more characters only
+// re-checks the rows still shown, any other edit starts again from the full list.
+class WindowFilterModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit WindowFilterModel(WindowListModel *sourceModel, QObject *parent = nullptr);
+
+    void setFilterText(const QString &text);
+
+    int sourceRow(int row) const {
+        return visibleRows[row];
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    void rebuild(bool narrowing);
+    static bool matches(const QString &filterKey, const QString &needle);
+
+    WindowListModel *sourceModel;
+    QString filterText;
+    std::vector<int> visibleRows;
+};
\ No newline at end of file
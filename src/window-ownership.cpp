@@ -0,0 +1,78 @@
+#include "window-ownership.hpp"
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------CLAIMING--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+WindowOwnership::ClaimResult WindowOwnership::claim(HWND hwnd, const QString &dockId, int priority, QString *previousOwner) {
+    auto ownerIter = owners.find(hwnd);
+
+    // A claim left behind by a window that has since been destroyed does not count
+    if (ownerIter != owners.end() && !IsWindow(hwnd)) {
+        owners.erase(ownerIter);
+        ownerIter = owners.end();
+    }
+
+    if (ownerIter == owners.end()) {
+        owners.insert(hwnd, Claim{dockId, priority});
+        return Granted;
+    }
+
+    Claim &owner = ownerIter.value();
+    if (owner.dockId == dockId) {
+        owner.priority = priority;
+        return Granted;
+    }
+
+    conflicts++;
+    if (owner.priority <= priority) {
+        return Denied;
+    }
+
+    // The window goes to the dock that takes precedence
+    if (previousOwner) {
+        *previousOwner = owner.dockId;
+    }
+    owner.dockId = dockId;
+    owner.priority = priority;
+    handovers++;
+    return Granted;
+}
+
+void WindowOwnership::release(HWND hwnd) {
+    owners.remove(hwnd);
+}
+
+void WindowOwnership::releaseDock(const QString &dockId) {
+    for (auto ownerIter = owners.begin(); ownerIter != owners.end();) {
+        if (ownerIter.value().dockId == dockId) {
+            ownerIter = owners.erase(ownerIter);
+        } else {
+            ++ownerIter;
+        }
+    }
+}
+
+QSet<HWND> WindowOwnership::ownedByOthers(const QString &dockId) const {
+    QSet<HWND> windows;
+    for (auto ownerIter = owners.constBegin(); ownerIter != owners.constEnd(); ++ownerIter) {
+        if (ownerIter.value().dockId != dockId) {
+            windows.insert(ownerIter.key());
+        }
+    }
+    return windows;
+}
+
+QJsonObject WindowOwnership::toJson() const {
+    return QJsonObject{
+        {"ownedWindows", (int)owners.size()},
+        {"conflicts", conflicts},
+        {"handovers", handovers}
+    };
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+
+
+// Which dock owns which native window. Every embed has to claim its window here first, so two docks
+// configured for the same title cannot keep stealing the window from each other. A window only ever
+// moves to a dock that takes precedence, so it cannot go back and forth between two docks.
+class WindowOwnership {
+public:
+    enum ClaimResult {
+        Granted,
+        Denied // Owned by a dock that takes precedence
+    };
+
+    // Lower priority values win, docks use their position in the config
+    ClaimResult claim(HWND hwnd, const QString &dockId, int priority, QString *previousOwner = nullptr);
+    void release(HWND hwnd);
+    void releaseDock(const QString &dockId);
+
+    QString ownerOf(HWND hwnd) const {
+        return owners.value(hwnd).dockId;
+    }
+
+    // Windows an enumeration match for this dock has to skip
+    QSet<HWND> ownedByOthers(const QString &dockId) const;
+
+    QJsonObject toJson() const;
+
+private:
+    struct Claim {
+        QString dockId;
+        int priority = 0;
+    };
+
+    QHash<HWND, Claim> owners;
+    int conflicts = 0;
+    int handovers = 0;
+};
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "window-registry.hpp"
+
+#include "trace-recorder.hpp"
+#include "dock-log.hpp"
+#include "frame-impact.hpp"
+
+#include <QJsonArray>
+
+#include <algorithm>
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-------------------------------------ENUMERATION-------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+BOOL CALLBACK WindowRegistry::enumWindowsCallback(HWND hwnd, LPARAM lParam) {
+    auto* registry = reinterpret_cast<WindowRegistry*>(lParam);
+
+    if (!hwnd || !IsWindow(hwnd)) {
+        DOCK_LOG(LOG_WARNING, "EnumWindowsProc: invalid HWND 0x%llx", hwnd);
+        return TRUE;  // Continue enumeration even if an invalid window handle is found
+    }
+
+    registry->stats.enumerated++;
+    if (!registry->filterWindow(hwnd)) {
+        DOCK_LOG(LOG_DEBUG, "EnumWindowsProc: filtered out 0x%llx", hwnd);
+    }
+
+    return TRUE;  // Continue enumeration
+}
+
+bool WindowRegistry::filterWindow(HWND hwnd) {
+    uint64_t stageStart = os_gettime_ns();
+
+    // Ends the current stage, rejecting the window when the stage did not pass it
+    auto endStage = [this, &stageStart](WindowFilterStats::Stage stage, bool passed) {
+        uint64_t now = os_gettime_ns();
+        stats.stageNs[stage] += (qint64)(now - stageStart);
+        stageStart = now;
+        if (!passed) {
+            stats.rejected[stage]++;
+        }
+        return passed;
+    };
+
+    // Stage 1: style bits, no calls into other processes
+    LONG_PTR style = GetWindowLongPtr(hwnd, GWL_STYLE);
+    LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+    bool appWindow = (exStyle & WS_EX_APPWINDOW) != 0;
+
+    bool passed = (style & WS_VISIBLE) != 0;
+    if (passed && filterSettings.skipToolWindows) {
+        passed = !(exStyle & WS_EX_TOOLWINDOW) || appWindow;
+    }
+    if (!endStage(WindowFilterStats::StageStyle, passed)) {
+        return false;
+    }
+
+    // Stage 2: owner, owning process and cloaking (background UWP windows, other virtual desktops)
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+
+    if (filterSettings.skipOwnedWindows && GetWindow(hwnd, GW_OWNER) && !appWindow) {
+        passed = false;
+    } else if (filterSettings.skipOwnProcess && processId == GetCurrentProcessId()) {
+        passed = false;
+    } else if (filterSettings.skipCloakedWindows) {
+        DWORD cloaked = 0;
+        passed = FAILED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) || !cloaked;
+    }
+    if (!endStage(WindowFilterStats::StageOwner, passed)) {
+        return false;
+    }
+
+    // Stage 3: the title, wide and at full length
+    QString title = queryTitle(hwnd);
+    if (!endStage(WindowFilterStats::StageTitle, !title.isEmpty())) {
+        return false;
+    }
+
+    // Stage 4: process metadata, the only stage that opens another process
+    auto pathIter = processPaths.constFind(processId);
+    if (pathIter == processPaths.constEnd()) {
+        pathIter = processPaths.insert(processId, queryProcessPath(processId));
+    }
+
+    const QString &processPath = pathIter.value();
+    QString processName = processPath.mid(processPath.lastIndexOf('\\') + 1);
+
+    passed = !processPath.isEmpty() && !filterSettings.excludedExecutables.contains(processName, Qt::CaseInsensitive);
+    if (!endStage(WindowFilterStats::StageProcess, passed)) {
+        return false;
+    }
+
+    wchar_t className[256];
+    int classLength = GetClassNameW(hwnd, className, 256);
+
+    entries.push_back({hwnd, processId, title, processName, processPath, QString::fromWCharArray(className, classLength)});
+    stats.accepted++;
+    return true;
+}
+
+QString WindowRegistry::queryTitle(HWND hwnd) {
+    int titleLength = GetWindowTextLengthW(hwnd);
+    if (titleLength <= 0) {
+        return QString();
+    }
+
+    std::vector<wchar_t> titleBuffer(titleLength + 1);
+    int copied = GetWindowTextW(hwnd, titleBuffer.data(), titleLength + 1);
+    return QString::fromWCharArray(titleBuffer.data(), copied);
+}
+
+QString WindowRegistry::queryProcessPath(DWORD processId) {
+    QString processPath;
+    HANDLE processHandle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (processHandle) {
+        wchar_t pathBuffer[MAX_PATH];
+        DWORD pathLength = MAX_PATH;
+        if (QueryFullProcessImageNameW(processHandle, 0, pathBuffer, &pathLength)) {
+            processPath = QString::fromWCharArray(pathBuffer, (int)pathLength);
+        } else {
+            // blog(LOG_WARNING, "EnumWindowsProc: Failed to get process name for PID: %lu", processId);
+        }
+        CloseHandle(processHandle);
+    } else {
+        // blog(LOG_WARNING, "EnumWindowsProc: Failed to open process for PID: %lu", processId);
+    }
+    return processPath;
+}
+
+const std::vector<WindowInfo>& WindowRegistry::refresh() {
+    entries.clear();
+    processPaths.clear();
+    stats = WindowFilterStats();
+    uint64_t refreshStart = os_gettime_ns();
+
+    if (!EnumWindows(enumWindowsCallback, reinterpret_cast<LPARAM>(this))) {
+        blog(LOG_ERROR, "EnumWindows failed with error: %lu", GetLastError());
+    }
+
+    blog(LOG_DEBUG, "Enumerated %d windows, kept %d (rejected: style %d, owner %d, title %d, process %d; "
+         "stage time: %.3f / %.3f / %.3f / %.3f ms)",
+         stats.enumerated, stats.accepted,
+         stats.rejected[WindowFilterStats::StageStyle], stats.rejected[WindowFilterStats::StageOwner],
+         stats.rejected[WindowFilterStats::StageTitle], stats.rejected[WindowFilterStats::StageProcess],
+         stats.stageNs[WindowFilterStats::StageStyle] / 1000000.0, stats.stageNs[WindowFilterStats::StageOwner] / 1000000.0,
+         stats.stageNs[WindowFilterStats::StageTitle] / 1000000.0, stats.stageNs[WindowFilterStats::StageProcess] / 1000000.0);
+
+    qint64 refreshNs = (qint64)(os_gettime_ns() - refreshStart);
+    refreshTotals.refreshes++;
+    refreshTotals.lastRefreshNs = refreshNs;
+    refreshTotals.maxRefreshNs = std::max(refreshTotals.maxRefreshNs, refreshNs);
+
+    TraceRecorder::instance().recordEnumeration(entries);
+    FrameImpactMonitor::instance().recordEvent(FRAME_IMPACT_ENUMERATION);
+
+    return entries;
+}
+
+void WindowRegistry::setFilterSettings(const WindowFilterSettings &settings) {
+    filterSettings = settings;
+}
+
+const WindowFilterSettings& WindowRegistry::getFilterSettings() const {
+    return filterSettings;
+}
+
+const WindowFilterStats& WindowRegistry::lastStats() const {
+    return stats;
+}
+
+const WindowRegistryTotals& WindowRegistry::totals() const {
+    return refreshTotals;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------SETTINGS--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+QJsonObject WindowFilterSettings::toJson() const {
+    QJsonObject settingsObject;
+    settingsObject["skipToolWindows"] = skipToolWindows;
+    settingsObject["skipOwnedWindows"] = skipOwnedWindows;
+    settingsObject["skipCloakedWindows"] = skipCloakedWindows;
+    settingsObject["skipOwnProcess"] = skipOwnProcess;
+    settingsObject["excludedExecutables"] = QJsonArray::fromStringList(excludedExecutables);
+    return settingsObject;
+}
+
+WindowFilterSettings WindowFilterSettings::fromJson(const QJsonObject &settingsObject) {
+    WindowFilterSettings settings;
+    settings.skipToolWindows = settingsObject["skipToolWindows"].toBool(settings.skipToolWindows);
+    settings.skipOwnedWindows = settingsObject["skipOwnedWindows"].toBool(settings.skipOwnedWindows);
+    settings.skipCloakedWindows = settingsObject["skipCloakedWindows"].toBool(settings.skipCloakedWindows);
+    settings.skipOwnProcess = settingsObject["skipOwnProcess"].toBool(settings.skipOwnProcess);
+
+    for (const QJsonValue &executable : settingsObject["excludedExecutables"].toArray()) {
+        settings.excludedExecutables.append(executable.toString());
+    }
+
+    return settings;
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*---------------------------------------LOOKUP----------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+const std::vector<WindowInfo>& WindowRegistry::windows() const {
+    return entries;
+}
+
+const WindowInfo* WindowRegistry::findByHwnd(HWND hwnd) const {
+    for (const WindowInfo &window : entries) {
+        if (window.hwnd == hwnd) {
+            return &window;
+        }
+    }
+
+    return nullptr;
+}
+
+WindowInfo WindowRegistry::describe(HWND hwnd) {
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    QString processPath = queryProcessPath(processId);
+
+    wchar_t className[256];
+    int classLength = GetClassNameW(hwnd, className, 256);
+
+    return {hwnd, processId, queryTitle(hwnd), processPath.mid(processPath.lastIndexOf('\\') + 1), processPath,
+            QString::fromWCharArray(className, classLength)};
+}
+
+const WindowInfo* WindowRegistry::findByTitle(const QString &title) const {
+    for (const WindowInfo &window : entries) {
+        if (window.title == title) {
+            return &window;
+        }
+    }
+
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <windows.h>
+#include <psapi.h>
+#include <dwmapi.h>
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#pragma comment(lib, "Dwmapi.lib")
+
+
+// A top-level desktop window as seen by the last enumeration
+struct WindowInfo {
+    HWND hwnd;
+    DWORD processId;
+    QString title;
+    QString executable;
+    QString executablePath;
+    QString className;
+
+    // Format the string as "[APPLICATION_EXECUTABLE]: WINDOW_NAME". Built on first use only, most
+    // enumerated windows never end up in a dropdown or a dock entry.
+    const QString &label() const {
+        if (cachedLabel.isNull()) {
+            cachedLabel = QLatin1Char('[') + executable + QLatin1String("]: ") + title;
+        }
+        return cachedLabel;
+    }
+
+    mutable QString cachedLabel; // Filled in by label()
+};
+
+
+// Which windows the enumeration leaves out, stored under "windowFilter" in settings.json
+struct WindowFilterSettings {
+    bool skipToolWindows = true;
+    bool skipOwnedWindows = true;
+    bool skipCloakedWindows = true;
+    bool skipOwnProcess = true;
+    QStringList excludedExecutables;
+
+    QJsonObject toJson() const;
+    static WindowFilterSettings fromJson(const QJsonObject &settingsObject);
+};
+
+
+// Windows rejected by each stage of the last enumeration, and the time spent in each stage. The
+// stages run cheapest first, so most windows never reach the costly ones.
+struct WindowFilterStats {
+    enum Stage {
+        StageStyle,
+        StageOwner,
+        StageTitle,
+        StageProcess,
+        StageCount
+    };
+
+    int enumerated = 0;
+    int accepted = 0;
+    int rejected[StageCount] = {};
+    qint64 stageNs[StageCount] = {};
+};
+
+
+// Enumeration cost since the plugin was loaded, published with the rest of the metrics
+struct WindowRegistryTotals {
+    quint64 refreshes = 0;
+    qint64 lastRefreshNs = 0;
+    qint64 maxRefreshNs = 0;
+};
+
+
+// Single source of truth for the desktop windows the plugin can dock. Every consumer (the
+// window picker, the scripting API, the dock matcher) reads the same snapshot, so one
+// enumeration serves all of them instead of each caller walking EnumWindows on its own.
+class WindowRegistry {
+public:
+    const std::vector<WindowInfo>& refresh();
+    const std::vector<WindowInfo>& windows() const;
+
+    const WindowInfo* findByHwnd(HWND hwnd) const;
+    const WindowInfo* findByTitle(const QString &title) const;
+
+    // Queries a single window directly, without an enumeration and without the filters
+    static WindowInfo describe(HWND hwnd);
+
+    void setFilterSettings(const WindowFilterSettings &settings);
+    const WindowFilterSettings& getFilterSettings() const;
+    const WindowFilterStats& lastStats() const;
+    const WindowRegistryTotals& totals() const;
+
+private:
+    static BOOL CALLBACK enumWindowsCallback(HWND hwnd, LPARAM lParam);
+    static QString queryProcessPath(DWORD processId);
+    static QString queryTitle(HWND hwnd);
+    bool filterWindow(HWND hwnd);
+
+    std::vector<WindowInfo> entries;
+    WindowFilterSettings filterSettings;
+    WindowFilterStats stats;
+    WindowRegistryTotals refreshTotals;
+
+    // Executable path per process, windows of the same process only query it once per enumeration
+    QHash<DWORD, QString> processPaths;
+};
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "window-watcher.hpp"
+
+#include <obs-module.h>
+
+#include "frame-impact.hpp"
+
+
+WindowWatcher& WindowWatcher::instance() {
+    static WindowWatcher windowWatcher;
+    return windowWatcher;
+}
+
+void WindowWatcher::watch(HWND hwnd) {
+    if (!hwnd || watched.contains(hwnd)) {
+        return;
+    }
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    if (!processId) {
+        return;
+    }
+
+    // Out-of-context hooks are delivered on this (UI) thread through its message loop
+    ProcessHook &processHook = processHooks[processId];
+    if (!processHook.hook) {
+        processHook.hook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY, nullptr, winEventProc, processId, 0,
+                                           WINEVENT_OUTOFCONTEXT);
+    }
+    processHook.windows++;
+    watched.insert(hwnd, processId);
+}
+
+void WindowWatcher::unwatch(HWND hwnd) {
+    // Every dock lets go of its window through here, whether it was released, handed over or destroyed
+    FrameImpactMonitor::instance().recordRelease(hwnd);
+
+    auto watchedIter = watched.find(hwnd);
+    if (watchedIter == watched.end()) {
+        return;
+    }
+
+    DWORD processId = watchedIter.value();
+    watched.erase(watchedIter);
+
+    auto hookIter = processHooks.find(processId);
+    if (hookIter != processHooks.end() && --hookIter->windows <= 0) {
+        if (hookIter->hook) {
+            UnhookWinEvent(hookIter->hook);
+        }
+        processHooks.erase(hookIter);
+    }
+}
+
+void WindowWatcher::setAwaiting(bool awaiting) {
+    if (awaiting == (showHook != nullptr)) {
+        return;
+    }
+
+    if (awaiting) {
+        showHook = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, nullptr, winEventProc, 0, 0,
+                                   WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        nameChangeHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, winEventProc, 0, 0,
+                                         WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        return;
+    }
+
+    if (showHook) {
+        UnhookWinEvent(showHook);
+        showHook = nullptr;
+    }
+    if (nameChangeHook) {
+        UnhookWinEvent(nameChangeHook);
+        nameChangeHook = nullptr;
+    }
+}
+
+void WindowWatcher::stop() {
+    setAwaiting(false);
+
+    for (const ProcessHook &processHook : processHooks) {
+        if (processHook.hook) {
+            UnhookWinEvent(processHook.hook);
+        }
+    }
+    processHooks.clear();
+    watched.clear();
+}
+
+void CALLBACK WindowWatcher::winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                                          DWORD eventThread, DWORD eventTime) {
+    UNUSED_PARAMETER(hook);
+    UNUSED_PARAMETER(eventThread);
+    UNUSED_PARAMETER(eventTime);
+
+    // Only whole windows matter, not their accessible children
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hwnd) {
+        return;
+    }
+
+    WindowWatcher &windowWatcher = instance();
+    if (event == EVENT_OBJECT_DESTROY) {
+        if (windowWatcher.watched.contains(hwnd)) {
+            emit windowWatcher.windowDestroyed(hwnd);
+        }
+        return;
+    }
+
+    // A docked window is no longer top-level, so this only reports windows on the desktop
+    if (GetAncestor(hwnd, GA_ROOT) == hwnd) {
+        emit windowWatcher.windowAppeared(hwnd);
+    }
+}
\ No newline at end of file
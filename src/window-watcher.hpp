@@ -0,0 +1,43 @@
+#pragma once
+
+#include <windows.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+
+// Win event hooks for the docked windows. Destroy notifications are only hooked for the processes
+// that own a docked window, and windows appearing anywhere are only reported while a dock waits for
+// its window to come back, so nothing is hooked system wide in the common case.
+class WindowWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    static WindowWatcher& instance();
+
+    void watch(HWND hwnd);
+    void unwatch(HWND hwnd);
+    void setAwaiting(bool awaiting); // Report top-level windows being shown or renamed
+    void stop();
+
+signals:
+    void windowDestroyed(HWND hwnd);
+    void windowAppeared(HWND hwnd);
+
+private:
+    WindowWatcher() = default;
+
+    static void CALLBACK winEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                                      DWORD eventThread, DWORD eventTime);
+
+    struct ProcessHook {
+        HWINEVENTHOOK hook = nullptr;
+        int windows = 0;
+    };
+
+    QHash<HWND, DWORD> watched; // Window to its process
+    QHash<DWORD, ProcessHook> processHooks;
+    HWINEVENTHOOK showHook = nullptr;
+    HWINEVENTHOOK nameChangeHook = nullptr;
+};
\ No newline at end of file
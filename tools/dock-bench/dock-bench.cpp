@@ -0,0 +1,301 @@
+// Benchmarks the per dock hot paths of the plugin (dock ID interning and lookups, config keys, native
+// titles, title matching) and the dock dialog's entries at 1,000 rows without OBS. On glibc every heap allocation is counted, the ones made inside
+// Qt included, and a hot path that still allocates in steady state fails the run.
+
+#include "dock-config.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+#define DOCK_BENCH_COUNTS_ALLOCATIONS 1
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+#endif
+
+
+constexpr int BENCH_DEFAULT_DOCKS = 64;
+constexpr int BENCH_DEFAULT_ITERATIONS = 1000;
+constexpr int BENCH_DEFAULT_ENTRIES = 1000;
+constexpr int BENCH_WINDOWS = 200; // Desktop windows a dock title is matched against
+
+static std::atomic<unsigned long long> allocationCount{0};
+static std::atomic<long long> liveBytes{0};
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------ALLOCATION COUNTER--------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+#ifdef DOCK_BENCH_COUNTS_ALLOCATIONS
+// The executable's definitions take the place of glibc's for Qt and libstdc++ as well
+static void *countAllocation(void *ptr, long long previousBytes) {
+    if (ptr) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_add((long long)malloc_usable_size(ptr) - previousBytes, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+extern "C" void *malloc(size_t size) noexcept {
+    return countAllocation(__libc_malloc(size), 0);
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept {
+    return countAllocation(__libc_calloc(count, size), 0);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) noexcept {
+    long long previousBytes = ptr ? (long long)malloc_usable_size(ptr) : 0;
+    return countAllocation(__libc_realloc(ptr, size), previousBytes);
+}
+
+extern "C" void free(void *ptr) noexcept {
+    if (ptr) {
+        liveBytes.fetch_sub((long long)malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+    __libc_free(ptr);
+}
+#endif
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------------PHASES--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+static volatile unsigned long long sink; // Keeps the measured loops from being optimized away
+
+// Runs the body once to warm up, then iterations times under the counters. Returns false when a phase
+// that must not allocate did.
+static bool runPhase(const char *name, int docks, int iterations, bool allocationFree, const std::function<void()> &body) {
+    body();
+
+    unsigned long long allocationsBefore = allocationCount.load();
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    qint64 elapsedNs = phaseTimer.nsecsElapsed();
+    unsigned long long allocations = allocationCount.load() - allocationsBefore;
+
+    double operations = (double)docks * iterations;
+#ifdef DOCK_BENCH_COUNTS_ALLOCATIONS
+    printf("%-12s %10.0f ops %9.1f ns/op %9.3f allocs/op%s\n", name, operations, elapsedNs / operations, allocations / operations,
+           allocationFree ? "" : "  (not checked)");
+    return !allocationFree || allocations == 0;
+#else
+    printf("%-12s %10.0f ops %9.1f ns/op\n", name, operations, elapsedNs / operations);
+    (void)allocations;
+    (void)allocationFree;
+    return true;
+#endif
+}
+
+static QJsonObject makeDockObject(int index) {
+    DockConfig config;
+    config.dockId = QString("Dock_%1_%2").arg(index).arg(index * 7919, 6, 16, QLatin1Char('0'));
+    config.dockName = QString("Dock %1").arg(index);
+    config.desktopWindow = QString("Window %1 - Some App").arg(index);
+    config.desktopWindowWithProgramName = QString("[app%1.exe]: %2").arg(index).arg(config.desktopWindow);
+    return config.toJson();
+}
+
+static int runBenchmarks(int dockCount, int iterations) {
+    // Load the docks the way the plugin does: from JSON, with their IDs interned
+    DockIdPool dockIds;
+    std::vector<QJsonObject> dockObjects;
+    std::vector<DockConfig> configs;
+    QHash<QString, int> dockOrdinals;
+    QSet<QString> configuredDockIds;
+    for (int i = 0; i < dockCount; ++i) {
+        dockObjects.push_back(makeDockObject(i));
+        DockConfig config = DockConfig::fromJson(dockObjects.back());
+        config.dockId = dockIds.intern(config.dockId);
+        dockOrdinals.insert(config.dockId, i);
+        configuredDockIds.insert(config.dockId);
+        configs.push_back(config);
+    }
+
+    std::vector<QString> windowTitles;
+    for (int i = 0; i < BENCH_WINDOWS; ++i) {
+        windowTitles.push_back(QString("Window %1 - Some App").arg(BENCH_WINDOWS - 1 - i));
+    }
+
+    bool passed = true;
+
+    passed &= runPhase("intern", dockCount, iterations, true, [&]() {
+        for (const DockConfig &config : configs) {
+            sink += dockIds.intern(config.dockId).size();
+        }
+    });
+
+    // What an Apply does per dock before touching OBS: is it configured, where does it go
+    passed &= runPhase("lookup", dockCount, iterations, true, [&]() {
+        for (const DockConfig &config : configs) {
+            sink += configuredDockIds.contains(config.dockId) + dockOrdinals.value(config.dockId, -1);
+        }
+    });
+
+    // The pointer handed to FindWindowW, a title read from JSON is already terminated
+    passed &= runPhase("title", dockCount, iterations, true, [&]() {
+        for (const DockConfig &config : configs) {
+            sink += config.desktopWindow.utf16()[0];
+        }
+    });
+
+    passed &= runPhase("match", dockCount, iterations, true, [&]() {
+        for (const DockConfig &config : configs) {
+            for (const QString &title : windowTitles) {
+                if (title == config.desktopWindow) {
+                    sink += 1;
+                    break;
+                }
+            }
+        }
+    });
+
+    passed &= runPhase("keys", dockCount, iterations, false, [&]() {
+        for (const QJsonObject &dockObject : dockObjects) {
+            sink += dockObject.contains(DockConfigKeys::DockId) + dockObject.contains(DockConfigKeys::Fingerprint);
+        }
+    });
+
+    passed &= runPhase("roundTrip", dockCount, iterations, false, [&]() {
+        for (const QJsonObject &dockObject : dockObjects) {
+            sink += DockConfig::fromJson(dockObject).toJson().size();
+        }
+    });
+
+    return passed ? 0 : 1;
+}
+
+// A copy of the config that shares no string data, what each entry held before original and current shared
+static DockConfig deepCopy(const DockConfig &config) {
+    DockConfig copy = config;
+    copy.dockId = QString(config.dockId.constData(), config.dockId.size());
+    copy.dockName = QString(config.dockName.constData(), config.dockName.size());
+    copy.desktopWindow = QString(config.desktopWindow.constData(), config.desktopWindow.size());
+    copy.desktopWindowWithProgramName = QString(config.desktopWindowWithProgramName.constData(), config.desktopWindowWithProgramName.size());
+    return copy;
+}
+
+static bool stringsDiffer(const DockConfig &original, const DockConfig &current) {
+    return original.dockId != current.dockId || original.dockName != current.dockName ||
+           original.desktopWindow != current.desktopWindow || original.desktopWindowWithProgramName != current.desktopWindowWithProgramName;
+}
+
+static int runEntryBenchmarks(int entryCount, int iterations) {
+    DockIdPool dockIds;
+    std::vector<QJsonObject> dockObjects;
+    for (int i = 0; i < entryCount; ++i) {
+        dockObjects.push_back(makeDockObject(i));
+    }
+
+    // Memory of the dialog's entries as readDockEntries() builds them, next to entries sharing nothing
+    long long bytesBefore = liveBytes.load();
+    std::vector<DockEntry> entries;
+    entries.reserve(entryCount);
+    for (const QJsonObject &dockObject : dockObjects) {
+        DockConfig config = DockConfig::fromJson(dockObject);
+        config.dockId = dockIds.intern(config.dockId);
+        entries.emplace_back(config);
+    }
+    long long sharedBytes = liveBytes.load() - bytesBefore;
+
+    bytesBefore = liveBytes.load();
+    std::vector<std::pair<DockConfig, DockConfig>> unshared;
+    unshared.reserve(entryCount);
+    for (const DockEntry &entry : entries) {
+        unshared.emplace_back(deepCopy(entry.original), deepCopy(entry.original));
+    }
+    long long unsharedBytes = liveBytes.load() - bytesBefore;
+
+#ifdef DOCK_BENCH_COUNTS_ALLOCATIONS
+    printf("%-12s %10d entries %9.1f bytes/entry (%.1f without shared strings)\n", "entries", entryCount,
+           (double)sharedBytes / entryCount, (double)unsharedBytes / entryCount);
+#else
+    (void)sharedBytes;
+    (void)unsharedBytes;
+#endif
+
+    // Every Apply asks each entry what changed, once through the dirty mask and once the old way
+    bool passed = true;
+    passed &= runPhase("dirtyCheck", entryCount, iterations, true, [&]() {
+        for (const DockEntry &entry : entries) {
+            sink += entry.isModified() + entry.isRenamed() + entry.isRetargeted() + entry.needsRecreate();
+        }
+    });
+
+    passed &= runPhase("stringCheck", entryCount, iterations, false, [&]() {
+        for (const auto &configs : unshared) {
+            sink += stringsDiffer(configs.first, configs.second);
+        }
+    });
+
+    // An edit that puts the loaded value back, as a dialog row does when its field loses the focus
+    passed &= runPhase("edit", entryCount, iterations, true, [&]() {
+        for (DockEntry &entry : entries) {
+            entry.setDockName(entry.original.dockName);
+            sink += entry.isModified();
+        }
+    });
+
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    int dockCount = BENCH_DEFAULT_DOCKS;
+    int iterations = BENCH_DEFAULT_ITERATIONS;
+    int entryCount = BENCH_DEFAULT_ENTRIES;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--docks") == 0) {
+            dockCount = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--iterations") == 0) {
+            iterations = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--entries") == 0) {
+            entryCount = atoi(argv[++i]);
+        } else {
+            dockCount = 0;
+            break;
+        }
+    }
+
+    if (dockCount <= 0 || iterations <= 0 || entryCount <= 0) {
+        fprintf(stderr, "usage: %s [--docks N] [--entries N] [--iterations N]\n", argv[0]);
+        return 2;
+    }
+
+    int result = runBenchmarks(dockCount, iterations) | runEntryBenchmarks(entryCount, iterations);
+    if (result != 0) {
+        fprintf(stderr, "A hot path allocated in steady state\n");
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+// Dumps the window dock metrics segment. On Windows it reads the live segment of a running OBS,
+// anywhere it can read a segment saved to a file, and --write-sample produces such a file so the
+// format and the seqlock can be checked without OBS.
+
+#include "metrics-format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+static const char *stateName(uint32_t state) {
+    switch (state) {
+    case METRICS_DOCK_SEARCHING: return "searching";
+    case METRICS_DOCK_EMBEDDED: return "embedded";
+    case METRICS_DOCK_DETACHED: return "detached";
+    case METRICS_DOCK_LOST: return "lost";
+    case METRICS_DOCK_DEGRADED: return "degraded";
+    case METRICS_DOCK_TILED: return "tiled";
+    default: return "unknown";
+    }
+}
+
+static int dump(const metrics_segment *segment) {
+    metrics_segment snapshot;
+    if (!metrics_read_segment(segment, &snapshot)) {
+        fprintf(stderr, "Segment stayed busy, no consistent snapshot\n");
+        return 1;
+    }
+
+    if (snapshot.magic != METRICS_FORMAT_MAGIC || snapshot.size != sizeof(metrics_segment)) {
+        fprintf(stderr, "Not a window dock metrics segment\n");
+        return 1;
+    }
+    if (snapshot.version != METRICS_FORMAT_VERSION) {
+        fprintf(stderr, "Unsupported metrics version %u\n", snapshot.version);
+        return 1;
+    }
+
+    printf("publish_count        %llu\n", (unsigned long long)snapshot.publish_count);
+    printf("publish_time_ns      %llu\n", (unsigned long long)snapshot.publish_time_ns);
+    printf("native_calls         %llu (%.1f/s)\n", (unsigned long long)snapshot.native_calls, snapshot.native_calls_per_sec);
+    printf("set_parent_calls     %llu\n", (unsigned long long)snapshot.set_parent_calls);
+    printf("set_window_pos_calls %llu (%.1f resizes/s)\n", (unsigned long long)snapshot.set_window_pos_calls, snapshot.resizes_per_sec);
+    printf("enumerations         %llu (last %llu us, max %llu us)\n", (unsigned long long)snapshot.enumerations,
+           (unsigned long long)snapshot.last_enumeration_us, (unsigned long long)snapshot.max_enumeration_us);
+    printf("hung_windows         %llu\n", (unsigned long long)snapshot.hung_windows);
+    printf("docks                %u\n", snapshot.dock_count);
+
+    uint32_t dockCount = snapshot.dock_count < METRICS_MAX_DOCKS ? snapshot.dock_count : METRICS_MAX_DOCKS;
+    for (uint32_t i = 0; i < dockCount; ++i) {
+        const metrics_dock &dock = snapshot.docks[i];
+        printf("  %-40.*s %-10s attaches %llu, last attach %u us, resizes %llu\n", METRICS_DOCK_ID_SIZE, dock.dock_id,
+               stateName(dock.state), (unsigned long long)dock.attaches, dock.last_attach_us, (unsigned long long)dock.resizes);
+    }
+    return 0;
+}
+
+static int writeSample(const char *path) {
+    static metrics_segment segment;
+    metrics_begin_write(&segment);
+    segment.magic = METRICS_FORMAT_MAGIC;
+    segment.version = METRICS_FORMAT_VERSION;
+    segment.size = sizeof(metrics_segment);
+    segment.publish_count = 1;
+    segment.native_calls = 42;
+    segment.set_parent_calls = 2;
+    segment.set_window_pos_calls = 12;
+    segment.enumerations = 3;
+    segment.last_enumeration_us = 850;
+    segment.max_enumeration_us = 1900;
+    segment.native_calls_per_sec = 4.0;
+    segment.resizes_per_sec = 1.5;
+    segment.dock_count = 2;
+    strncpy(segment.docks[0].dock_id, "Chat_1a2b3c", METRICS_DOCK_ID_SIZE - 1);
+    segment.docks[0].state = METRICS_DOCK_EMBEDDED;
+    segment.docks[0].attaches = 1;
+    segment.docks[0].last_attach_us = 3200;
+    segment.docks[0].resizes = 12;
+    strncpy(segment.docks[1].dock_id, "Notes_4d5e6f", METRICS_DOCK_ID_SIZE - 1);
+    segment.docks[1].state = METRICS_DOCK_SEARCHING;
+    metrics_end_write(&segment);
+
+    FILE *file = fopen(path, "wb");
+    if (!file || fwrite(&segment, sizeof(segment), 1, file) != 1) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        if (file) {
+            fclose(file);
+        }
+        return 1;
+    }
+    fclose(file);
+    return 0;
+}
+
+static int dumpFile(const char *path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return 1;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(metrics_segment)) : nullptr;
+    int result = view ? dump(static_cast<const metrics_segment*>(view)) : 1;
+    if (view) {
+        UnmapViewOfFile(view);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    return result;
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(metrics_segment)) {
+        fprintf(stderr, "Failed to open %s or it is too small\n", path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    void *view = mmap(nullptr, sizeof(metrics_segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s\n", path);
+        return 1;
+    }
+    int result = dump(static_cast<const metrics_segment*>(view));
+    munmap(view, sizeof(metrics_segment));
+    return result;
+#endif
+}
+
+#ifdef _WIN32
+static int dumpLive() {
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, METRICS_SEGMENT_NAME);
+    if (!mapping) {
+        fprintf(stderr, "No metrics segment, is OBS running with publishMetrics enabled?\n");
+        return 1;
+    }
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(metrics_segment));
+    int result = view ? dump(static_cast<const metrics_segment*>(view)) : 1;
+    if (view) {
+        UnmapViewOfFile(view);
+    }
+    CloseHandle(mapping);
+    return result;
+}
+#endif
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "--file") == 0) {
+        return dumpFile(argv[2]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--write-sample") == 0) {
+        return writeSample(argv[2]);
+    }
+#ifdef _WIN32
+    if (argc == 1) {
+        return dumpLive();
+    }
+#endif
+
+    fprintf(stderr, "usage: %s [--file PATH | --write-sample PATH]\n", argv[0]);
+    return 2;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Prints a window dock trace (see src/trace-format.h) one record per line, with its time since the
+// recording started. --write-sample produces a small trace, so the tools can be tried without OBS.
+
+#include "trace-file.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+
+static const char *recordName(trace_record_type type) {
+    switch (type) {
+    case TRACE_STRING: return "string";
+    case TRACE_ENUMERATION: return "enumeration";
+    case TRACE_WINDOW_CREATE: return "window create";
+    case TRACE_WINDOW_DESTROY: return "window destroy";
+    case TRACE_WINDOW_TITLE: return "window title";
+    case TRACE_WINDOW_RESIZE: return "window resize";
+    case TRACE_APPLY_BEGIN: return "apply begin";
+    case TRACE_APPLY_END: return "apply end";
+    case TRACE_DOCK_CREATE: return "dock create";
+    case TRACE_DOCK_REMOVE: return "dock remove";
+    case TRACE_DOCK_ATTACH: return "dock attach";
+    case TRACE_DOCK_DETACH: return "dock detach";
+    default: return "unknown";
+    }
+}
+
+static int dump(const char *path) {
+    TraceReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "%s: %s\n", path, reader.error().c_str());
+        return 1;
+    }
+
+    printf("trace version %u, started at %" PRIu64 " ns\n", reader.getVersion(), reader.getStartNs());
+
+    TraceRecord record;
+    uint64_t records = 0;
+    while (reader.next(record)) {
+        records++;
+        printf("%12.3f ms  %-14s ", record.timeUs / 1000.0, recordName(record.type));
+
+        switch (record.type) {
+        case TRACE_ENUMERATION:
+            printf("%zu windows\n", record.windows.size());
+            for (const TraceWindow &window : record.windows) {
+                printf("%30s0x%" PRIx64 " pid %" PRIu64 " [%s] \"%s\"\n", "", window.hwnd, window.processId,
+                       reader.string(window.executableId).c_str(), reader.string(window.titleId).c_str());
+            }
+            break;
+        case TRACE_WINDOW_CREATE:
+        case TRACE_WINDOW_DESTROY:
+            printf("0x%" PRIx64 "\n", record.hwnd);
+            break;
+        case TRACE_WINDOW_TITLE:
+            printf("0x%" PRIx64 " \"%s\"\n", record.hwnd, reader.string(record.titleId).c_str());
+            break;
+        case TRACE_WINDOW_RESIZE:
+            printf("0x%" PRIx64 " %" PRIu64 "x%" PRIu64 "\n", record.hwnd, record.width, record.height);
+            break;
+        case TRACE_APPLY_BEGIN:
+        case TRACE_APPLY_END:
+            printf("%" PRIu64 " entries\n", record.entryCount);
+            break;
+        default:
+            printf("%s 0x%" PRIx64 " \"%s\"\n", reader.string(record.dockId).c_str(), record.hwnd, reader.string(record.titleId).c_str());
+            break;
+        }
+    }
+
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s: %s after %" PRIu64 " records\n", path, reader.error().c_str(), records);
+        return 1;
+    }
+    printf("%" PRIu64 " records\n", records);
+    return 0;
+}
+
+static void writeDockAction(TraceWriter &writer, trace_record_type type, uint64_t timeUs, const char *dockId, uint64_t hwnd, const char *title) {
+    uint32_t dockIdId = writer.string(dockId);
+    uint32_t titleId = writer.string(title);
+    writer.begin(type, timeUs);
+    writer.varint(dockIdId);
+    writer.varint(hwnd);
+    writer.varint(titleId);
+}
+
+static void writeWindowTitle(TraceWriter &writer, uint64_t timeUs, uint64_t hwnd, const char *title) {
+    uint32_t titleId = writer.string(title);
+    writer.begin(TRACE_WINDOW_TITLE, timeUs);
+    writer.varint(hwnd);
+    writer.varint(titleId);
+}
+
+static void writeWindowEvent(TraceWriter &writer, trace_record_type type, uint64_t timeUs, uint64_t hwnd) {
+    writer.begin(type, timeUs);
+    writer.varint(hwnd);
+}
+
+// A dock whose window is open at startup, one whose app starts later and is found by the search,
+// a window that is closed and reopened, and an Apply that removes a dock
+static int writeSample(const char *path) {
+    TraceWriter writer(1000000000);
+
+    uint32_t chatTitle = writer.string("Twitch Chat - Chrome");
+    uint32_t chrome = writer.string("chrome.exe");
+    uint32_t notesTitle = writer.string("Untitled - Notepad");
+    uint32_t notepad = writer.string("notepad.exe");
+    const uint64_t windows[2][4] = {{0x1001, 100, chatTitle, chrome}, {0x1002, 200, notesTitle, notepad}};
+    writer.begin(TRACE_ENUMERATION, 0);
+    writer.varint(2);
+    for (const auto &window : windows) {
+        for (uint64_t value : window) {
+            writer.varint(value);
+        }
+    }
+
+    writeDockAction(writer, TRACE_DOCK_CREATE, 5000, "Chat_1a2b3c", 0, "Twitch Chat - Chrome");
+    writeDockAction(writer, TRACE_DOCK_ATTACH, 5000, "Chat_1a2b3c", 0x1001, "Twitch Chat - Chrome");
+    writeDockAction(writer, TRACE_DOCK_CREATE, 10000, "Music_4d5e6f", 0, "Spotify Premium");
+
+    writeWindowEvent(writer, TRACE_WINDOW_CREATE, 9000000, 0x1003);
+    writeWindowTitle(writer, 9001000, 0x1003, "Spotify Premium");
+    writeDockAction(writer, TRACE_DOCK_ATTACH, 18010000, "Music_4d5e6f", 0x1003, "Spotify Premium");
+
+    for (uint64_t i = 0; i < 5; ++i) {
+        writer.begin(TRACE_WINDOW_RESIZE, 15000000 + i * 16000);
+        writer.varint(0x1001);
+        writer.varint(400 + i * 10);
+        writer.varint(300);
+    }
+
+    writeWindowEvent(writer, TRACE_WINDOW_DESTROY, 20000000, 0x1001);
+    writeDockAction(writer, TRACE_DOCK_DETACH, 20000000, "Chat_1a2b3c", 0x1001, "");
+    writeWindowEvent(writer, TRACE_WINDOW_CREATE, 25000000, 0x1004);
+    writeWindowTitle(writer, 25001000, 0x1004, "Twitch Chat - Chrome");
+    writeDockAction(writer, TRACE_DOCK_ATTACH, 25021000, "Chat_1a2b3c", 0x1004, "Twitch Chat - Chrome");
+
+    writer.begin(TRACE_APPLY_BEGIN, 30000000);
+    writer.varint(1);
+    writeDockAction(writer, TRACE_DOCK_REMOVE, 30000100, "Music_4d5e6f", 0, "");
+    writeDockAction(writer, TRACE_DOCK_DETACH, 30000200, "Music_4d5e6f", 0x1003, "");
+    writer.begin(TRACE_APPLY_END, 30000300);
+    writer.varint(1);
+
+    if (!writer.save(path)) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && argv[1][0] != '-') {
+        return dump(argv[1]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--write-sample") == 0) {
+        return writeSample(argv[2]);
+    }
+
+    fprintf(stderr, "usage: %s TRACE | --write-sample PATH\n", argv[0]);
+    return 2;
+}
\ No newline at end of file
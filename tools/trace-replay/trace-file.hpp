@@ -0,0 +1,267 @@
+#pragma once
+
+// Reads and writes the binary trace described in src/trace-format.h, without OBS, Qt or Windows
+
+#include "trace-format.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+
+struct TraceWindow {
+    uint64_t hwnd = 0;
+    uint64_t processId = 0;
+    uint32_t titleId = 0;
+    uint32_t executableId = 0;
+};
+
+
+// One decoded record, which fields are set depends on the type (see trace-format.h)
+struct TraceRecord {
+    trace_record_type type = TRACE_STRING;
+    uint64_t timeUs = 0; // Since the recording started
+    uint64_t hwnd = 0;
+    uint32_t dockId = 0; // String id
+    uint32_t titleId = 0; // String id
+    uint64_t width = 0;
+    uint64_t height = 0;
+    uint64_t entryCount = 0;
+    std::vector<TraceWindow> windows;
+};
+
+
+class TraceReader {
+public:
+    bool open(const char *path) {
+        FILE *file = fopen(path, "rb");
+        if (!file) {
+            return fail(std::string("cannot open ") + path);
+        }
+
+        data.clear();
+        unsigned char chunk[65536];
+        size_t count;
+        while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            data.insert(data.end(), chunk, chunk + count);
+        }
+        fclose(file);
+
+        if (data.size() < 16 || std::string(data.begin(), data.begin() + 4) != TRACE_FORMAT_MAGIC) {
+            return fail("not a window dock trace");
+        }
+        version = (uint32_t)readLittleEndian(4, 4);
+        startNs = readLittleEndian(8, 8);
+        if (version != TRACE_FORMAT_VERSION) {
+            return fail("unsupported trace version " + std::to_string(version));
+        }
+
+        offset = 16;
+        timeUs = 0;
+        strings.clear();
+        return true;
+    }
+
+    // Decodes the next record. String records are collected on the way and never returned. Returns
+    // false at the end of the trace, or on a corrupt record with error() set.
+    bool next(TraceRecord &record) {
+        while (offset < data.size()) {
+            uint8_t type = data[offset++];
+            uint64_t deltaUs = 0;
+            if (!readVarint(deltaUs)) {
+                return fail("truncated record header");
+            }
+            timeUs += deltaUs;
+
+            record = TraceRecord();
+            record.type = (trace_record_type)type;
+            record.timeUs = timeUs;
+
+            bool complete = true;
+            switch (type) {
+            case TRACE_STRING: {
+                uint32_t id = 0;
+                uint64_t length = 0;
+                if (!readId(id) || !readVarint(length) || length > data.size() - offset) {
+                    return fail("truncated string");
+                }
+                // Ids are handed out in order, a string is never defined ahead of the ones before it
+                if (id > strings.size()) {
+                    return fail("string id out of order");
+                }
+                if (id == strings.size()) {
+                    strings.emplace_back();
+                }
+                strings[id].assign(data.begin() + offset, data.begin() + offset + length);
+                offset += length;
+                continue;
+            }
+            case TRACE_ENUMERATION: {
+                uint64_t count = 0;
+                // Every window takes at least four bytes, a larger count cannot be right
+                if (!readVarint(count) || count > (data.size() - offset) / 4) {
+                    return fail("truncated enumeration");
+                }
+                record.windows.resize(count);
+                for (TraceWindow &window : record.windows) {
+                    complete = complete && readVarint(window.hwnd) && readVarint(window.processId) && readId(window.titleId) &&
+                               readId(window.executableId);
+                }
+                break;
+            }
+            case TRACE_WINDOW_CREATE:
+            case TRACE_WINDOW_DESTROY:
+                complete = readVarint(record.hwnd);
+                break;
+            case TRACE_WINDOW_TITLE:
+                complete = readVarint(record.hwnd) && readId(record.titleId);
+                break;
+            case TRACE_WINDOW_RESIZE:
+                complete = readVarint(record.hwnd) && readVarint(record.width) && readVarint(record.height);
+                break;
+            case TRACE_APPLY_BEGIN:
+            case TRACE_APPLY_END:
+                complete = readVarint(record.entryCount);
+                break;
+            case TRACE_DOCK_CREATE:
+            case TRACE_DOCK_REMOVE:
+            case TRACE_DOCK_ATTACH:
+            case TRACE_DOCK_DETACH:
+                complete = readId(record.dockId) && readVarint(record.hwnd) && readId(record.titleId);
+                break;
+            default:
+                return fail("unknown record type " + std::to_string(type));
+            }
+
+            return complete || fail("truncated record");
+        }
+        return false;
+    }
+
+    const std::string &string(uint32_t id) const {
+        static const std::string empty;
+        return id < strings.size() ? strings[id] : empty;
+    }
+
+    uint32_t getVersion() const {
+        return version;
+    }
+
+    uint64_t getStartNs() const {
+        return startNs;
+    }
+
+    const std::string &error() const {
+        return errorMessage;
+    }
+
+private:
+    bool fail(const std::string &message) {
+        errorMessage = message;
+        offset = data.size();
+        return false;
+    }
+
+    uint64_t readLittleEndian(size_t position, int bytes) const {
+        uint64_t value = 0;
+        for (int i = bytes - 1; i >= 0; --i) {
+            value = (value << 8) | data[position + i];
+        }
+        return value;
+    }
+
+    bool readVarint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && offset < data.size(); shift += 7) {
+            uint8_t byte = data[offset++];
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readId(uint32_t &id) {
+        uint64_t value = 0;
+        if (!readVarint(value) || value > UINT32_MAX) {
+            return false;
+        }
+        id = (uint32_t)value;
+        return true;
+    }
+
+    std::vector<uint8_t> data;
+    size_t offset = 0;
+    uint64_t timeUs = 0;
+    uint32_t version = 0;
+    uint64_t startNs = 0;
+    std::vector<std::string> strings;
+    std::string errorMessage;
+};
+
+
+// Encodes a trace the way TraceRecorder does, for sample traces and tests
+class TraceWriter {
+public:
+    explicit TraceWriter(uint64_t startNs) {
+        data.insert(data.end(), TRACE_FORMAT_MAGIC, TRACE_FORMAT_MAGIC + 4);
+        writeLittleEndian(TRACE_FORMAT_VERSION, 4);
+        writeLittleEndian(startNs, 8);
+    }
+
+    // The first use of a string emits its TRACE_STRING record, like TraceRecorder::internString
+    uint32_t string(const std::string &value) {
+        auto stringIter = stringIds.find(value);
+        if (stringIter != stringIds.end()) {
+            return stringIter->second;
+        }
+
+        uint32_t id = (uint32_t)stringIds.size();
+        stringIds.emplace(value, id);
+        begin(TRACE_STRING, lastUs);
+        varint(id);
+        varint(value.size());
+        data.insert(data.end(), value.begin(), value.end());
+        return id;
+    }
+
+    void begin(trace_record_type type, uint64_t timeUs) {
+        data.push_back((uint8_t)type);
+        varint(timeUs > lastUs ? timeUs - lastUs : 0);
+        lastUs = timeUs > lastUs ? timeUs : lastUs;
+    }
+
+    void varint(uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            if (value) {
+                byte |= 0x80;
+            }
+            data.push_back(byte);
+        } while (value);
+    }
+
+    bool save(const char *path) const {
+        FILE *file = fopen(path, "wb");
+        bool written = file && fwrite(data.data(), 1, data.size(), file) == data.size();
+        if (file) {
+            written = fclose(file) == 0 && written;
+        }
+        return written;
+    }
+
+private:
+    void writeLittleEndian(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            data.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    std::vector<uint8_t> data;
+    std::map<std::string, uint32_t> stringIds;
+    uint64_t lastUs = 0;
+};
\ No newline at end of file
@@ -0,0 +1,423 @@
+// Replays a window dock trace (see src/trace-format.h) through a model of the plugin's window lookup,
+// search schedule, lost window rematch and window ownership, on a clock taken from the trace instead
+// of the wall clock. Searches follow the plugin's backoff without its jitter. The same trace always
+// gives the same result, so field traces can be kept as regression tests: the run fails when a dock
+// ends up with another window than in the recording, or with --max-attach-ms when a dock took longer
+// than that to get its window.
+
+#include "search-schedule.hpp"
+#include "trace-file.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+
+constexpr uint64_t NO_TIME = UINT64_MAX;
+
+
+// A desktop window as the registry sees it
+struct ReplayWindow {
+    std::string title;
+    std::string executable;
+    bool alive = true;
+};
+
+enum class ReplayDockState {
+    Searching,  // Looking for its window, on the search schedule while it lasts
+    Embedded,
+    Detached,   // Popped out, the window is still bound to the dock
+    Lost,       // The window was closed, a window with its title reopening is rematched
+    Removed
+};
+
+struct ReplayDock {
+    std::string windowTitle;
+    bool tiled = false; // Tiles are followed from the recording, not predicted
+    ReplayDockState state = ReplayDockState::Searching;
+    uint64_t hwnd = 0;
+    uint64_t recordedHwnd = 0; // Embedded window as recorded, 0 while none
+    uint64_t createdUs = 0;
+    uint64_t recordedAttachUs = NO_TIME;
+    uint64_t replayedAttachUs = NO_TIME;
+    uint64_t resizes = 0;
+    uint64_t generation = 0; // Bumped whenever the dock's pending search goes stale
+};
+
+// A search attempt of one dock, or a rematch of every lost dock when dockId is empty
+struct ReplayTask {
+    std::string dockId;
+    int attempt;
+    uint64_t generation;
+};
+
+
+class DockReplay {
+public:
+    explicit DockReplay(const TraceReader &reader)
+        : reader(reader) {}
+
+    void apply(const TraceRecord &record);
+    void finish(uint64_t endUs);
+    int report(int64_t maxAttachMs) const;
+
+private:
+    void runDue(uint64_t timeUs);
+    void schedule(uint64_t dueUs, const std::string &dockId, int attempt);
+    uint64_t findWindow(const std::string &dockId, const ReplayDock &dock) const;
+    void attach(const std::string &dockId, ReplayDock &dock, uint64_t hwnd, uint64_t timeUs);
+    void release(const std::string &dockId, ReplayDock &dock);
+    void search(const std::string &dockId, int attempt, uint64_t timeUs);
+    void rematch(uint64_t timeUs);
+
+    const TraceReader &reader;
+    std::map<uint64_t, ReplayWindow> windows; // By handle, so every lookup walks them in the same order
+    std::map<std::string, ReplayDock> docks;
+    std::map<uint64_t, std::string> owners;
+    std::multimap<uint64_t, ReplayTask> tasks; // Tasks due at the same time run in the order they were scheduled
+    bool inApply = false;
+    bool rematchPending = false;
+};
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------------MODEL---------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+void DockReplay::schedule(uint64_t dueUs, const std::string &dockId, int attempt) {
+    uint64_t generation = dockId.empty() ? 0 : docks[dockId].generation;
+    tasks.emplace(dueUs, ReplayTask{dockId, attempt, generation});
+}
+
+void DockReplay::runDue(uint64_t timeUs) {
+    while (!tasks.empty() && tasks.begin()->first <= timeUs) {
+        uint64_t dueUs = tasks.begin()->first;
+        ReplayTask task = tasks.begin()->second;
+        tasks.erase(tasks.begin());
+
+        if (task.dockId.empty()) {
+            rematch(dueUs);
+            continue;
+        }
+
+        auto dockIter = docks.find(task.dockId);
+        if (dockIter != docks.end() && dockIter->second.generation == task.generation) {
+            search(task.dockId, task.attempt, dueUs);
+        }
+    }
+}
+
+// The first live window with the dock's title that no other dock holds, like resolveDockWindow without a fingerprint
+uint64_t DockReplay::findWindow(const std::string &dockId, const ReplayDock &dock) const {
+    for (const auto &[hwnd, window] : windows) {
+        if (!window.alive || window.title != dock.windowTitle) {
+            continue;
+        }
+
+        auto ownerIter = owners.find(hwnd);
+        if (ownerIter == owners.end() || ownerIter->second == dockId) {
+            return hwnd;
+        }
+    }
+    return 0;
+}
+
+void DockReplay::attach(const std::string &dockId, ReplayDock &dock, uint64_t hwnd, uint64_t timeUs) {
+    release(dockId, dock);
+
+    // A window taken from another dock sends that dock back to searching, as claimWindow does
+    auto ownerIter = owners.find(hwnd);
+    if (ownerIter != owners.end() && ownerIter->second != dockId) {
+        std::string previousOwner = ownerIter->second;
+        ReplayDock &previousDock = docks[previousOwner];
+        previousDock.hwnd = 0;
+        previousDock.state = ReplayDockState::Searching;
+        previousDock.generation++;
+        schedule(timeUs + windowSearchDelayMs(0) * 1000ull, previousOwner, 0);
+    }
+
+    owners[hwnd] = dockId;
+    dock.hwnd = hwnd;
+    dock.state = ReplayDockState::Embedded;
+    dock.generation++;
+    if (dock.replayedAttachUs == NO_TIME) {
+        dock.replayedAttachUs = timeUs;
+    }
+}
+
+void DockReplay::release(const std::string &dockId, ReplayDock &dock) {
+    auto ownerIter = owners.find(dock.hwnd);
+    if (ownerIter != owners.end() && ownerIter->second == dockId) {
+        owners.erase(ownerIter);
+    }
+    dock.hwnd = 0;
+}
+
+void DockReplay::search(const std::string &dockId, int attempt, uint64_t timeUs) {
+    ReplayDock &dock = docks[dockId];
+    if (dock.state != ReplayDockState::Searching) {
+        return;
+    }
+
+    if (uint64_t hwnd = findWindow(dockId, dock)) {
+        attach(dockId, dock, hwnd, timeUs);
+    } else if (attempt + 1 < WINDOW_SEARCH_ATTEMPTS) {
+        schedule(timeUs + windowSearchDelayMs(attempt + 1) * 1000ull, dockId, attempt + 1);
+    }
+}
+
+void DockReplay::rematch(uint64_t timeUs) {
+    rematchPending = false;
+    for (auto &[dockId, dock] : docks) {
+        if (dock.state != ReplayDockState::Lost || dock.tiled) {
+            continue;
+        }
+
+        if (uint64_t hwnd = findWindow(dockId, dock)) {
+            attach(dockId, dock, hwnd, timeUs);
+        }
+    }
+}
+
+void DockReplay::apply(const TraceRecord &record) {
+    runDue(record.timeUs);
+    uint64_t now = record.timeUs;
+
+    switch (record.type) {
+    case TRACE_ENUMERATION:
+        // Filtered windows are left out of an enumeration, so it only adds to what is known
+        for (const TraceWindow &traceWindow : record.windows) {
+            ReplayWindow &window = windows[traceWindow.hwnd];
+            window.title = reader.string(traceWindow.titleId);
+            window.executable = reader.string(traceWindow.executableId);
+            window.alive = true;
+        }
+        break;
+    case TRACE_WINDOW_CREATE:
+        windows[record.hwnd] = ReplayWindow();
+        break;
+    case TRACE_WINDOW_TITLE: {
+        ReplayWindow &window = windows[record.hwnd];
+        window.title = reader.string(record.titleId);
+
+        // Only a title a lost dock waits for is worth a rematch, as in onWindowAppeared
+        for (const auto &[dockId, dock] : docks) {
+            if (!rematchPending && dock.state == ReplayDockState::Lost && !dock.tiled && dock.windowTitle == window.title) {
+                schedule(now + LOST_WINDOW_REMATCH_DELAY_MS * 1000ull, std::string(), 0);
+                rematchPending = true;
+            }
+        }
+        break;
+    }
+    case TRACE_WINDOW_DESTROY: {
+        auto windowIter = windows.find(record.hwnd);
+        if (windowIter != windows.end()) {
+            windowIter->second.alive = false;
+        }
+
+        // Embedded or popped out, the dock is bound to the window and loses it
+        auto ownerIter = owners.find(record.hwnd);
+        if (ownerIter != owners.end()) {
+            ReplayDock &dock = docks[ownerIter->second];
+            owners.erase(ownerIter);
+            dock.hwnd = 0;
+            dock.state = ReplayDockState::Lost;
+            dock.generation++;
+        }
+        break;
+    }
+    case TRACE_WINDOW_RESIZE: {
+        auto ownerIter = owners.find(record.hwnd);
+        if (ownerIter != owners.end()) {
+            docks[ownerIter->second].resizes++;
+        }
+        break;
+    }
+    case TRACE_APPLY_BEGIN:
+        inApply = true;
+        break;
+    case TRACE_APPLY_END:
+        inApply = false;
+        break;
+    case TRACE_DOCK_CREATE: {
+        const std::string &dockId = reader.string(record.dockId);
+        ReplayDock &dock = docks[dockId];
+        uint64_t generation = dock.generation + 1;
+        release(dockId, dock);
+
+        dock = ReplayDock();
+        dock.generation = generation;
+        dock.windowTitle = reader.string(record.titleId);
+        dock.tiled = dock.windowTitle.find(" | ") != std::string::npos;
+        dock.createdUs = now;
+        if (dock.tiled) {
+            break;
+        }
+
+        // Every dock is taken as shown right away. One created by an Apply looks once, one restored at
+        // startup or by a dock set switch keeps searching (materializeDockContent).
+        if (uint64_t hwnd = findWindow(dockId, dock)) {
+            attach(dockId, dock, hwnd, now);
+        } else if (!inApply) {
+            schedule(now + windowSearchDelayMs(0) * 1000ull, dockId, 0);
+        }
+        break;
+    }
+    case TRACE_DOCK_REMOVE: {
+        const std::string &dockId = reader.string(record.dockId);
+        auto dockIter = docks.find(dockId);
+        if (dockIter != docks.end()) {
+            release(dockId, dockIter->second);
+            dockIter->second.state = ReplayDockState::Removed;
+            dockIter->second.recordedHwnd = 0;
+            dockIter->second.generation++;
+        }
+        break;
+    }
+    case TRACE_DOCK_ATTACH: {
+        const std::string &dockId = reader.string(record.dockId);
+        const std::string &title = reader.string(record.titleId);
+        bool known = docks.count(dockId) > 0;
+        ReplayDock &dock = docks[dockId];
+        if (!known) {
+            dock.windowTitle = title;
+            dock.createdUs = now;
+        }
+
+        dock.recordedHwnd = record.hwnd;
+        if (dock.recordedAttachUs == NO_TIME) {
+            dock.recordedAttachUs = now;
+        }
+
+        // The replay predicts a dock finding its own window. Re-embedding after a pop-out (no title), a
+        // retarget (another title) and docks that were there before the recording are followed instead.
+        bool predicted = known && !title.empty() && title == dock.windowTitle && dock.state != ReplayDockState::Detached;
+        if (!dock.tiled && !predicted) {
+            if (!title.empty()) {
+                dock.windowTitle = title;
+            }
+            attach(dockId, dock, record.hwnd, now);
+        }
+        break;
+    }
+    case TRACE_DOCK_DETACH: {
+        const std::string &dockId = reader.string(record.dockId);
+        auto dockIter = docks.find(dockId);
+        if (dockIter == docks.end()) {
+            break;
+        }
+
+        ReplayDock &dock = dockIter->second;
+        dock.recordedHwnd = 0;
+
+        // A closed window was handled with its destroy record. Any other detach is a pop-out, the window
+        // stays bound to the dock until it is re-embedded, retargeted or closed.
+        if (dock.state == ReplayDockState::Embedded && dock.hwnd == record.hwnd) {
+            dock.state = ReplayDockState::Detached;
+            dock.generation++;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void DockReplay::finish(uint64_t endUs) {
+    runDue(endUs);
+}
+
+
+
+
+/*-------------------------------------------------------------------------------------*/
+/*-----------------------------------------REPORT--------------------------------------*/
+/*-------------------------------------------------------------------------------------*/
+
+
+
+
+static std::string formatLatency(uint64_t attachUs, uint64_t createdUs) {
+    if (attachUs == NO_TIME) {
+        return "never";
+    }
+
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f s", (attachUs - createdUs) / 1000000.0);
+    return text;
+}
+
+int DockReplay::report(int64_t maxAttachMs) const {
+    int failures = 0;
+    for (const auto &[dockId, dock] : docks) {
+        uint64_t replayedHwnd = dock.state == ReplayDockState::Embedded ? dock.hwnd : 0;
+        bool mismatch = !dock.tiled && replayedHwnd != dock.recordedHwnd;
+        bool tooSlow = maxAttachMs >= 0 && !dock.tiled && dock.replayedAttachUs != NO_TIME &&
+                       dock.replayedAttachUs - dock.createdUs > (uint64_t)maxAttachMs * 1000;
+
+        printf("%-32s recorded 0x%" PRIx64 " after %s, replayed 0x%" PRIx64 " after %s, %" PRIu64 " resizes%s%s%s\n",
+               dockId.c_str(), dock.recordedHwnd, formatLatency(dock.recordedAttachUs, dock.createdUs).c_str(), replayedHwnd,
+               formatLatency(dock.replayedAttachUs, dock.createdUs).c_str(), dock.resizes, dock.tiled ? " (tiled, followed)" : "",
+               mismatch ? "  MISMATCH" : "", tooSlow ? "  TOO SLOW" : "");
+        failures += mismatch || tooSlow;
+    }
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    int64_t maxAttachMs = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--max-attach-ms") == 0) {
+            maxAttachMs = atoll(argv[++i]);
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+
+    if (!path) {
+        fprintf(stderr, "usage: %s TRACE [--max-attach-ms N]\n", argv[0]);
+        return 2;
+    }
+
+    TraceReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "%s: %s\n", path, reader.error().c_str());
+        return 1;
+    }
+
+    auto replayStart = std::chrono::steady_clock::now();
+    DockReplay replay(reader);
+    TraceRecord record;
+    uint64_t records = 0;
+    uint64_t endUs = 0;
+    while (reader.next(record)) {
+        replay.apply(record);
+        endUs = record.timeUs;
+        records++;
+    }
+    replay.finish(endUs);
+    double replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replayStart).count();
+
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s: %s after %" PRIu64 " records\n", path, reader.error().c_str(), records);
+        return 1;
+    }
+
+    int failures = replay.report(maxAttachMs);
+    printf("replayed %" PRIu64 " records covering %.3f s in %.3f ms, %d docks failed\n", records, endUs / 1000000.0, replayMs, failures);
+    return failures > 0 ? 1 : 0;
+}
\ No newline at end of file